@@ -0,0 +1,53 @@
+/*
+Time: 2026-10-17
+Test: Values constructed outside an int2048_resource_scope keep their own memory.
+std Time: 0.00s
+Time Limit: 1.00s
+Notes: Run under AddressSanitizer; any use of the released resource's memory is an error.
+*/
+
+#include "int2048.h"
+#include <string>
+
+using sjtu::int2048;
+
+signed main() {
+    const int2048 big {std::string(200, '9')};
+
+    // in-place growth of an inline value inside the scope
+    int2048 total {5};
+    {
+        sjtu::int2048_monotonic_resource mono;
+        {
+            sjtu::int2048_resource_scope scope(&mono);
+            total += big;
+        }
+    }
+    std::cout << total << '\n';
+
+    // move-assignment of a result built inside the scope
+    int2048 acc;
+    {
+        sjtu::int2048_monotonic_resource mono;
+        sjtu::int2048_resource_scope scope(&mono);
+        acc = big * big;
+        mono.release();
+        acc += 1;
+    }
+    std::cout << acc << '\n';
+
+    // swap moves each block together with its resource, so the values trade resources;
+    // swapping back before the scope ends returns every block to its source
+    int2048 outer {std::string(100, '1')};
+    {
+        sjtu::int2048_monotonic_resource mono;
+        sjtu::int2048_resource_scope scope(&mono);
+        int2048 inner = big + 1;
+        swap(outer, inner);
+        std::cout << outer << '\n';
+        inner += big;
+        swap(outer, inner);
+    }
+    std::cout << outer << '\n';
+    return 0;
+}
@@ -0,0 +1,39 @@
+/*
+Time: 2026-10-17
+Test: Radix and binary conversion caches filled inside an int2048_resource_scope.
+std Time: 0.00s
+Time Limit: 1.00s
+Notes: Run under AddressSanitizer. Expected output is "1 1 1".
+*/
+
+#include "int2048.h"
+#include <string>
+
+using sjtu::int2048;
+using sjtu::int2048_bin;
+
+signed main() {
+    std::string digits;
+    for (int i = 0; i < 6000; ++i)
+        digits += char('1' + i * 7 % 9);
+    const int2048 x {digits};
+
+    // the first conversions of the thread fill their caches inside the scope
+    std::string hex, x2;
+    int2048 parsed;
+    {
+        sjtu::int2048_monotonic_resource mono;
+        sjtu::int2048_resource_scope scope(&mono);
+        hex = x.to_string(16);
+        int2048 y;
+        y.read(hex, 16);
+        x2 = int2048_bin(digits).to_int2048().to_string();
+        mono.release();
+    }
+
+    // the same conversions again, after the resource is gone
+    parsed.read(hex, 16);
+    std::cout << (x.to_string(16) == hex) << ' ' << (parsed == x) << ' '
+              << (int2048_bin(digits).to_int2048().to_string() == x2) << '\n';
+    return 0;
+}
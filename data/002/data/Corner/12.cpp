@@ -0,0 +1,53 @@
+/*
+Time: 2026-10-17
+Test: int2048::divisor against / and %.
+std Time: 0.00s
+Time Limit: 1.00s
+Notes: Every line of output is "1".
+*/
+
+#include "int2048.h"
+#include <string>
+
+using sjtu::int2048;
+
+int2048 digits(std::size_t n, unsigned seed) {
+    std::string s(1, char('1' + seed % 9));
+    for (std::size_t i = 1; i < n; ++i) {
+        seed = seed * 1103515245u + 12345u;
+        s += char('0' + seed / 65536 % 10);
+    }
+    return int2048(s);
+}
+
+// Divides dividends of several lengths and both signs by d through a prepared divisor
+bool check(const int2048 &d) {
+    const int2048::divisor prepared(d);
+    bool ok = prepared.value() == d;
+    const std::size_t len = d.to_string().size();
+    for (std::size_t n : {std::size_t(1), len / 2 + 1, len, len + 3, 2 * len, 3 * len}) {
+        for (int sign : {1, -1}) {
+            const int2048 a = sign * digits(n, unsigned(n * 31 + len));
+            int2048 q, r;
+            prepared.divmod(a, q, r);
+            ok = ok && q == a / d && r == a % d && prepared.div(a) == q && prepared.mod(a) == r;
+            // q and r may alias the dividend
+            int2048 x = a, y = a;
+            prepared.divmod(x, x, r);
+            prepared.divmod(y, q, y);
+            ok = ok && x == a / d && y == a % d;
+        }
+    }
+    return ok;
+}
+
+signed main() {
+    // one-limb, short and reciprocal-backed divisors, both signs
+    for (std::size_t n : {1, 3, 20, 120, 127, 128, 400, 2000}) {
+        const int2048 d = digits(n, unsigned(n));
+        std::cout << (check(d) && check(-d)) << '\n';
+    }
+    // a power of the base, whose normalized form is itself
+    std::cout << check(int2048("1" + std::string(200, '0'))) << '\n';
+    return 0;
+}
@@ -0,0 +1,71 @@
+/*
+Time: 2026-10-17
+Test: powmod on the Montgomery and Barrett paths, signs and edge cases.
+std Time: 0.00s
+Time Limit: 1.00s
+Notes: Expected output is
+    24 1 0 0 0 0
+    2 -2 3 -8 0 -2
+    1 1 1 1
+    1 1 1 1
+*/
+
+#include "int2048.h"
+#include <string>
+
+using sjtu::int2048;
+
+int2048 digits(std::size_t n, unsigned seed) {
+    std::string s(1, char('1' + seed % 9));
+    for (std::size_t i = 1; i < n; ++i) {
+        seed = seed * 1103515245u + 12345u;
+        s += char('0' + seed / 65536 % 10);
+    }
+    return int2048(s);
+}
+
+// Right-to-left square and multiply with plain % as the reference
+int2048 reference(int2048 base, long long exp, const int2048 &m) {
+    int2048 res = 1 % m;
+    base = base % m;
+    for (; exp > 0; exp >>= 1) {
+        if (exp & 1)
+            res = res * base % m;
+        base = base * base % m;
+    }
+    return res;
+}
+
+int2048 pm(long long base, long long exp, long long m) { return powmod(int2048(base), int2048(exp), int2048(m)); }
+
+signed main() {
+    // exp = 0 and m = +-1
+    std::cout << pm(2, 10, 1000) << ' ' << pm(12345, 0, 7) << ' ' << pm(12345, 0, 1) << ' '
+              << pm(12345, 0, -1) << ' ' << pm(12345, 678, 1) << ' ' << pm(-12345, 678, -1) << '\n';
+
+    // negative base and negative modulus follow floor semantics: (-2)^3 = -8
+    std::cout << pm(-2, 3, 5) << ' ' << pm(2, 3, -5) << ' ' << pm(-2, 3, 11) << ' '
+              << pm(-2, 3, -11) << ' ' << pm(-10, 3, 10) << ' ' << pm(-1, 0, -3) << '\n';
+
+    // moduli coprime to 10 take the Montgomery ring, word by word and with REDC by
+    // multiplication from 160 limbs on
+    for (std::size_t n : {7, 60, 641, 900}) {
+        int2048 m = digits(n, unsigned(n));
+        while (m % 2 == 0 || m % 5 == 0)
+            m += 1;
+        const int2048 b = digits(n + 5, 3);
+        const long long e = 1000003;
+        std::cout << (powmod(b, int2048(e), m) == reference(b, e, m) && powmod(-b, int2048(e), -m) == reference(-b, e, -m)) << ' ';
+    }
+    std::cout << '\n';
+
+    // moduli sharing a factor with 10 take the Barrett ring
+    for (std::size_t n : {7, 60, 641, 900}) {
+        const int2048 m = digits(n, unsigned(n)) * 10 + (n % 2 == 0 ? 5 : 2);
+        const int2048 b = digits(n + 5, 3);
+        const long long e = 1000003;
+        std::cout << (powmod(b, int2048(e), m) == reference(b, e, m) && powmod(-b, int2048(e), -m) == reference(-b, e, -m)) << ' ';
+    }
+    std::cout << '\n';
+    return 0;
+}
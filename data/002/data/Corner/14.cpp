@@ -0,0 +1,54 @@
+/*
+Time: 2026-10-17
+Test: int2048_bin arithmetic, comparison and conversion against int2048.
+std Time: 0.00s
+Time Limit: 1.00s
+Notes: Expected output is "-1234567890123456789 0 5" followed by lines of "1".
+*/
+
+#include "int2048.h"
+#include <sstream>
+#include <string>
+
+using sjtu::int2048;
+using sjtu::int2048_bin;
+
+std::string digits(std::size_t n, unsigned seed) {
+    std::string s(1, char('1' + seed % 9));
+    for (std::size_t i = 1; i < n; ++i) {
+        seed = seed * 1103515245u + 12345u;
+        s += char('0' + seed / 65536 % 10);
+    }
+    return s;
+}
+
+signed main() {
+    std::istringstream iss {"-1234567890123456789 -0"};
+    int2048_bin x, z;
+    iss >> x >> z;
+    std::cout << x << ' ' << z << ' ' << int2048_bin(5) << '\n';
+
+    // schoolbook, Karatsuba (from 40 limbs) and FFT (from 800 limbs) products
+    for (std::size_t n : {1, 9, 10, 200, 400, 3000, 8000, 20000}) {
+        for (int signs = 0; signs < 4; ++signs) {
+            std::string sa = digits(n, unsigned(n)), sb = digits(n / 2 + 1, unsigned(n + 7));
+            if (signs & 1)
+                sa = "-" + sa;
+            if (signs & 2)
+                sb = "-" + sb;
+            const int2048 a(sa), b(sb);
+            const int2048_bin ba(sa), bb(sb);
+            bool ok = int2048_bin(a) == ba && ba.to_int2048() == a;
+            ok = ok && (ba + bb).to_int2048() == a + b && (ba - bb).to_int2048() == a - b;
+            ok = ok && (ba * bb).to_int2048() == a * b && (ba * ba).to_int2048() == a * a;
+            ok = ok && (ba - ba) == int2048_bin(0) && (ba < bb) == (a < b) && (ba >= bb) == (a >= b);
+            ok = ok && (-ba).to_int2048() == -a && (+ba) == ba;
+            std::ostringstream oss;
+            oss << ba;
+            ok = ok && oss.str() == a.to_string();
+            std::cout << ok;
+        }
+        std::cout << '\n';
+    }
+    return 0;
+}
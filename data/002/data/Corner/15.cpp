@@ -0,0 +1,61 @@
+/*
+Time: 2026-10-17
+Test: read and to_string with a radix.
+std Time: 0.00s
+Time Limit: 1.00s
+Notes: Expected output is
+    ff -11111111 zz -7b 0 0
+    255 -1295 255 0
+followed by lines of "1".
+*/
+
+#include "int2048.h"
+#include <string>
+
+using sjtu::int2048;
+
+const char DIGITS[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+
+int2048 read_radix(const std::string &s, int radix) {
+    int2048 x;
+    x.read(s, radix);
+    return x;
+}
+
+// Horner's rule over int2048 arithmetic as the reference
+int2048 horner(const std::string &s, int radix) {
+    int2048 res;
+    for (char c : s)
+        res = res * radix + int(std::string(DIGITS).find(c));
+    return res;
+}
+
+signed main() {
+    std::cout << int2048(255).to_string(16) << ' ' << int2048(-255).to_string(2) << ' '
+              << int2048(1295).to_string(36) << ' ' << int2048(-123).to_string(16) << ' '
+              << int2048(0).to_string(7) << ' ' << int2048(0).to_string(36) << '\n';
+    std::cout << read_radix("FF", 16) << ' ' << read_radix("-Zz", 36) << ' ' << read_radix("+0000ff", 16) << ' '
+              << read_radix("-000", 2) << '\n';
+
+    // from one digit to well past the base case of 32 chunks
+    for (std::size_t n : {1, 15, 16, 17, 100, 1000, 12000}) {
+        bool ok = true;
+        for (int radix = 2; radix <= 36; ++radix) {
+            std::string s(1, DIGITS[1 + n % (radix - 1)]);
+            unsigned seed = unsigned(n * 37 + radix);
+            for (std::size_t i = 1; i < n; ++i) {
+                seed = seed * 1103515245u + 12345u;
+                s += DIGITS[seed / 65536 % radix];
+            }
+            const int2048 x = read_radix(s, radix);
+            ok = ok && x.to_string(radix) == s && read_radix("-" + s, radix) == -x;
+            ok = ok && (-x).to_string(radix) == "-" + s;
+            if (n <= 1000)
+                ok = ok && x == horner(s, radix);
+        }
+        const int2048 y = read_radix(std::string(n, '7'), 8);
+        ok = ok && y.to_string(10) == y.to_string();
+        std::cout << ok << '\n';
+    }
+    return 0;
+}
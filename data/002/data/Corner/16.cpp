@@ -0,0 +1,50 @@
+/*
+Time: 2026-10-17
+Test: Decimal to_string and to_chars.
+std Time: 0.00s
+Time Limit: 1.00s
+Notes: Expected output is
+    0 -1 10000 -100000001 1000000000000
+followed by lines of "1".
+*/
+
+#include "int2048.h"
+#include <sstream>
+#include <string>
+
+using sjtu::int2048;
+
+// to_chars into a buffer of exactly the right size and one byte too short
+bool check(const std::string &s) {
+    const int2048 x(s);
+    std::ostringstream oss;
+    oss << x;
+    std::string buf(s.size() + 1, '#');
+    char *end = x.to_chars(&buf[0], &buf[0] + s.size());
+    bool ok = x.to_string() == s && oss.str() == s;
+    ok = ok && end == &buf[0] + s.size() && buf.compare(0, s.size(), s) == 0 && buf[s.size()] == '#';
+    std::string shorter(s.size(), '#');
+    ok = ok && x.to_chars(&shorter[0], &shorter[0] + s.size() - 1) == nullptr &&
+         shorter == std::string(s.size(), '#');
+    return ok;
+}
+
+signed main() {
+    std::cout << int2048(0).to_string() << ' ' << int2048(-1).to_string() << ' ' << int2048(10000).to_string()
+              << ' ' << int2048("-0000100000001").to_string() << ' ' << int2048(1000000000000LL).to_string()
+              << '\n';
+
+    std::cout << (check("0") && check("-7") && check("9999") && check("-10000") && check("100000000")) << '\n';
+
+    // top limbs of every width, inner limbs below 1000 and long values
+    for (std::size_t n : {5, 6, 7, 8, 9, 40, 4001, 100002}) {
+        std::string s(1, char('1' + n % 9));
+        unsigned seed = unsigned(n);
+        for (std::size_t i = 1; i < n; ++i) {
+            seed = seed * 1103515245u + 12345u;
+            s += seed / 65536 % 3 == 0 ? '0' : char('0' + seed / 65536 % 10);
+        }
+        std::cout << (check(s) && check("-" + s)) << '\n';
+    }
+    return 0;
+}
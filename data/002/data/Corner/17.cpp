@@ -0,0 +1,78 @@
+/*
+Time: 2026-10-17
+Test: int2048_reader and int2048_writer with tokens and values across buffer boundaries.
+std Time: 0.00s
+Time Limit: 1.00s
+Notes: Expected output is "-9223372036854775808 9223372036854775807 0 1" followed by
+lines of "1".
+*/
+
+#include "int2048.h"
+#include <sstream>
+#include <string>
+#include <vector>
+
+using sjtu::int2048;
+
+signed main() {
+    // machine integers at both ends of the range, then the end of the input
+    {
+        std::istringstream iss {"-9223372036854775808 9223372036854775807\n-0"};
+        sjtu::int2048_reader reader(iss);
+        long long a, b, c;
+        reader.read(a);
+        reader.read(b);
+        reader.read(c);
+        std::cout << a << ' ' << b << ' ' << c << ' ' << !reader.read(a) << '\n';
+    }
+
+    // tokens from 1 to 200 characters, separated by every kind of whitespace; the last
+    // one ends the input without a separator
+    std::vector<std::string> tokens;
+    std::string text = " \t";
+    const char *const separators[] = {" ", "\n", "\t", "\r\n", "   ", "\v\f"};
+    unsigned seed = 1;
+    for (std::size_t i = 0; i < 120; ++i) {
+        const std::size_t len = 1 + i * 17 % 200;
+        std::string s = i % 3 == 0 ? "-" : i % 7 == 0 ? "+" : "";
+        for (std::size_t j = 0; j < len; ++j) {
+            seed = seed * 1103515245u + 12345u;
+            s += char('0' + seed / 65536 % 10);
+        }
+        tokens.push_back(s);
+        text += s;
+        if (i + 1 < 120)
+            text += separators[i % 6];
+    }
+
+    for (std::size_t chunk : {1, 16, 17, 64, 1 << 16}) {
+        std::istringstream iss {text};
+        sjtu::int2048_reader reader(iss, chunk);
+        bool ok = true;
+        std::size_t count = 0;
+        int2048 x;
+        while (reader.read(x)) {
+            ok = ok && count < tokens.size() && x == int2048(tokens[count]);
+            ++count;
+        }
+        std::cout << (ok && count == tokens.size()) << '\n';
+    }
+
+    // the writer must produce exactly what operator<< does, including values longer than
+    // its buffer
+    for (std::size_t capacity : {1, 64, 100, 1 << 16}) {
+        std::ostringstream expected, actual;
+        {
+            sjtu::int2048_writer writer(actual, capacity);
+            for (std::size_t i = 0; i < tokens.size(); ++i) {
+                const int2048 x(tokens[i]);
+                expected << x << ' ' << (long long)(i * i) - 5000 << '\n';
+                writer.write(x).put(' ').write((long long)(i * i) - 5000).put('\n');
+            }
+            expected << (-9223372036854775807LL - 1);
+            writer.write(-9223372036854775807LL - 1);
+        }
+        std::cout << (actual.str() == expected.str()) << '\n';
+    }
+    return 0;
+}
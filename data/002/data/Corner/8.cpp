@@ -0,0 +1,22 @@
+/*
+Time: 2026-10-17
+Test: Operator - with an rvalue right operand that aliases the left one.
+std Time: 0.00s
+Time Limit: 1.00s
+Notes: Expected output is "0 0 -12345".
+*/
+
+#include "int2048.h"
+#include <utility>
+
+using sjtu::int2048;
+
+signed main() {
+    int2048 a {12345};
+    std::cout << a - std::move(a) << ' ';
+    int2048 b {"-123456789012345678901234567890"};
+    std::cout << b - std::move(b) << ' ';
+    int2048 c {12345};
+    std::cout << int2048(0) - std::move(c) << '\n';
+    return 0;
+}
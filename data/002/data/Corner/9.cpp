@@ -0,0 +1,32 @@
+/*
+Time: 2026-10-17
+Test: deserialize rejects records with out-of-range limbs.
+std Time: 0.00s
+Time Limit: 1.00s
+Notes: Expected output is "1 12345678\n0 12345678\n0 12345678".
+*/
+
+#include "int2048.h"
+#include <string>
+
+using sjtu::int2048;
+
+signed main() {
+    const std::string record = int2048 {12345678}.serialize();
+    int2048 x;
+    const char *end = int2048::deserialize(record.data(), record.data() + record.size(), x);
+    std::cout << (end == record.data() + record.size()) << ' ' << x << '\n';
+
+    // patch the low limb (5678) to 0xFFFF, then to 10000
+    const std::size_t low = record.size() - 4;
+    std::string bad = record;
+    bad[low] = bad[low + 1] = char(0xFF);
+    end = int2048::deserialize(bad.data(), bad.data() + bad.size(), x);
+    std::cout << (end != nullptr) << ' ' << x << '\n';
+
+    const unsigned short limit = 10000;
+    std::memcpy(&bad[low], &limit, 2);
+    end = int2048::deserialize(bad.data(), bad.data() + bad.size(), x);
+    std::cout << (end != nullptr) << ' ' << x << '\n';
+    return 0;
+}
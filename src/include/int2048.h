@@ -18,6 +18,64 @@
 // Do not use "using namespace std;"
 
 namespace sjtu {
+class int2048_memory_resource;
+
+// Limb storage for int2048: the subset of std::vector<int> the kernels use, keeping up to
+// INLINE_LIMBS limbs (any long long) inside the object and moving to the heap only beyond
+// that, so small values and temporaries never allocate. Heap blocks come from the memory
+// resource in scope when the vector was constructed (see int2048_resource_scope).
+class limb_vector {
+public:
+  typedef int value_type;
+  typedef int *iterator;
+  typedef const int *const_iterator;
+  static const unsigned INLINE_LIMBS = 6;
+
+  limb_vector();
+  explicit limb_vector(std::size_t n, int value = 0);
+  limb_vector(const int *first, const int *last);
+  limb_vector(const limb_vector &);
+  limb_vector(limb_vector &&) noexcept;
+  ~limb_vector();
+
+  limb_vector &operator=(const limb_vector &);
+  limb_vector &operator=(limb_vector &&) noexcept;
+  void swap(limb_vector &) noexcept;
+
+  std::size_t size() const;
+  std::size_t capacity() const;
+  bool empty() const;
+  int *data();
+  const int *data() const;
+  int &operator[](std::size_t);
+  const int &operator[](std::size_t) const;
+  int &back();
+  const int &back() const;
+  iterator begin();
+  iterator end();
+  const_iterator begin() const;
+  const_iterator end() const;
+
+  void push_back(int);
+  void pop_back();
+  void clear();
+  void reserve(std::size_t);
+  void resize(std::size_t n, int value = 0);
+  void assign(std::size_t n, int value);
+  iterator insert(const_iterator pos, std::size_t n, int value);
+  iterator insert(const_iterator pos, const int *first, const int *last);
+
+private:
+  bool is_inline() const;
+  // Room for n more limbs at pos, contents shifted up; returns the gap
+  iterator open_gap(const_iterator pos, std::size_t n);
+
+  int *data_; // buf_ or a heap block of cap_ limbs
+  unsigned size_, cap_;
+  int buf_[INLINE_LIMBS];
+  int2048_memory_resource *resource_; // source of every heap block, null for the arena
+};
+
 class int2048 {
 private:
   static const int BASE = 10000;
@@ -25,24 +83,78 @@ private:
 
   // sign_: 1 (positive), -1 (negative), 0 (zero)
   int sign_;
-  std::vector<int> a_; // little-endian digits in BASE
+  limb_vector a_; // little-endian digits in BASE
 
   void trim();
+  int2048 &assign_word(long long);
   static int abs_compare(const int2048 &, const int2048 &);
-  static std::vector<int> abs_add_vec(const std::vector<int> &, const std::vector<int> &);
-  static std::vector<int> abs_sub_vec(const std::vector<int> &, const std::vector<int> &); // assume lhs >= rhs
-  static std::vector<int> multiply_schoolbook(const std::vector<int> &, const std::vector<int> &);
-  static std::vector<int> multiply_fft(const std::vector<int> &, const std::vector<int> &);
-  static void fft(std::vector<std::complex<long double>> &, bool);
+  // In-place magnitude kernels: carries and borrows stop as soon as they die out
+  static void abs_add_inplace(limb_vector &, const limb_vector &);
+  static void abs_sub_inplace(limb_vector &, const limb_vector &);  // assume lhs >= rhs
+  static void abs_rsub_inplace(limb_vector &, const limb_vector &); // lhs = rhs - lhs, assume rhs >= lhs
+  static limb_vector multiply_schoolbook(const limb_vector &, const limb_vector &);
+  static limb_vector multiply_recursive(const limb_vector &, const limb_vector &); // Karatsuba / Toom-3
+  static limb_vector multiply_fft(const limb_vector &, const limb_vector &);
+  static limb_vector multiply_ntt(const limb_vector &, const limb_vector &);
+  static limb_vector multiply_vec(const limb_vector &, const limb_vector &);
+  static limb_vector square_schoolbook(const limb_vector &);
+  static limb_vector square_recursive(const limb_vector &);
+  static limb_vector square_fft(const limb_vector &);
+  static limb_vector square_vec(const limb_vector &);
+  static void fft(std::complex<double> *, std::size_t n, bool);
+  // In place: with real sequences A and B packed as A + iB in n points, leaves their
+  // cyclic convolution in the real parts
+  static void fft_packed_product(std::complex<double> *, std::size_t n);
 
+  static void divmod_schoolbook(const limb_vector &, const limb_vector &, limb_vector &q, limb_vector &r);
+  static limb_vector reciprocal_vec(const limb_vector &); // divisor must be normalized
+  static void divmod_reciprocal(const limb_vector &, const limb_vector &, const limb_vector &inv,
+                                limb_vector &q, limb_vector &r);
+  static void divmod_newton(const limb_vector &, const limb_vector &, limb_vector &q, limb_vector &r);
   static void divmod_abs(const int2048 &x, const int2048 &y, int2048 &q, int2048 &r);
+  // Turns the magnitudes from divmod_abs into the floor quotient and remainder of a / b
+  static void divmod_fix_signs(int a_sign, const int2048 &b, int2048 &q, int2048 &r);
+  // Residue rings for powmod, defined in int2048.cpp: Montgomery form for moduli coprime
+  // to BASE, Barrett reduction through int2048::divisor otherwise
+  struct montgomery_ring;
+  struct barrett_ring;
+
+  // Cached powers radix^(chunk 2^k) and their prepared divisors for read(s, radix) and
+  // to_string(radix), defined in int2048.cpp
+  struct radix_table;
+  static limb_vector parse_radix(const char *, std::size_t, const radix_table &);
+  static void print_radix(const int2048 &, std::size_t level, std::size_t width, const radix_table &, std::string &);
+  // Decimal digits of limbs [0, n) from the top limb down, the top one without padding
+  static char *format_limbs(const int *, std::size_t n, char *out);
+  std::size_t decimal_length() const; // including the sign
+
+  int2048 &add_signed(const int2048 &, int rhs_sign);
+  int2048 &add_word(unsigned long long magnitude, int rhs_sign);
+  // Floor division by a machine integer in place; returns the remainder, signed like b
+  long long divmod_word(long long b);
+  static int compare_word(const int2048 &, long long);
+
+  // converts to and from base-10000 limbs
+  friend class int2048_bin;
+  friend class int2048_view;
 
 public:
+  // Algorithm used for products above the Karatsuba/Toom-3 tier, set per thread:
+  // fft (the default) is the packed double-precision transform (checked, with an exact
+  // fallback), ntt is the three-prime NTT + CRT.
+  enum class multiply_backend { fft, ntt };
+  static void set_multiply_backend(multiply_backend);
+  static multiply_backend get_multiply_backend();
+
   // Constructors
   int2048();
   int2048(long long);
   int2048(const std::string &);
   int2048(const int2048 &);
+  int2048(int2048 &&) noexcept;
+
+  void swap(int2048 &) noexcept;
+  friend void swap(int2048 &, int2048 &) noexcept;
 
   // The parameter types of the following functions are for reference only, you can choose to use constant references or not
   // If needed, you can add other required functions yourself
@@ -52,9 +164,32 @@ public:
 
   // Read a big integer
   void read(const std::string &);
+  // Same, from the characters [first, last)
+  void read(const char *first, const char *last);
   // Output the stored big integer, no need for newline
   void print();
 
+  // Text in radix 2..36 with digits 0-9 and a-z (either case when reading). Radices other
+  // than 10 are converted divide-and-conquer in O(M(n) log n).
+  void read(const std::string &, int radix);
+  std::string to_string(int radix) const;
+
+  // Decimal text. to_chars writes into [first, last) without a terminator and returns the
+  // end of the written range, or nullptr (writing nothing) if the range is too short.
+  std::string to_string() const;
+  char *to_chars(char *first, char *last) const;
+
+  // Binary record: "i2k", format version, a 16-bit endianness marker, the sign byte, one
+  // padding byte, a 64-bit limb count and the base-10000 limbs as 16-bit words, all in
+  // the writer's byte order. serialize(out) writes serialized_size() bytes and returns
+  // their end; deserialize returns the end of the record, or nullptr (leaving the target
+  // alone) if it is malformed or holds a limb of 10000 or more.
+  static const unsigned char SERIAL_VERSION = 1;
+  std::size_t serialized_size() const;
+  char *serialize(char *out) const;
+  std::string serialize() const;
+  static const char *deserialize(const char *first, const char *last, int2048 &);
+
   // Add a big integer
   int2048 &add(const int2048 &);
   // Return the sum of two big integers
@@ -69,25 +204,58 @@ public:
   // Integer2
   // ===================================
 
-  int2048 operator+() const;
-  int2048 operator-() const;
+  int2048 operator+() const &;
+  int2048 operator+() &&;
+  int2048 operator-() const &;
+  int2048 operator-() &&;
 
   int2048 &operator=(const int2048 &);
+  int2048 &operator=(int2048 &&) noexcept;
 
   int2048 &operator+=(const int2048 &);
   friend int2048 operator+(int2048, const int2048 &);
+  friend int2048 operator+(const int2048 &, int2048 &&);
 
   int2048 &operator-=(const int2048 &);
   friend int2048 operator-(int2048, const int2048 &);
+  friend int2048 operator-(const int2048 &, int2048 &&);
 
   int2048 &operator*=(const int2048 &);
+  // Replace the value with its square; cheaper than x *= y for a distinct y
+  int2048 &square();
   friend int2048 operator*(int2048, const int2048 &);
+  friend int2048 operator*(const int2048 &, int2048 &&);
 
   int2048 &operator/=(const int2048 &);
   friend int2048 operator/(int2048, const int2048 &);
 
   int2048 &operator%=(const int2048 &);
   friend int2048 operator%(int2048, const int2048 &);
+  // Floor quotient and remainder in one division; q and r may alias a or b
+  friend void divmod(const int2048 &a, const int2048 &b, int2048 &q, int2048 &r);
+  // Same, by a machine integer, with the remainder returned as one
+  friend void divmod(const int2048 &a, long long b, int2048 &q, long long &r);
+
+  // Machine integer operands go straight to scalar kernels instead of through int2048(long long)
+  int2048 &operator+=(long long);
+  int2048 &operator-=(long long);
+  int2048 &operator*=(long long);
+  int2048 &operator/=(long long);
+  int2048 &operator%=(long long);
+  friend int2048 operator+(int2048, long long);
+  friend int2048 operator+(long long, int2048);
+  friend int2048 operator-(int2048, long long);
+  friend int2048 operator-(long long, int2048);
+  friend int2048 operator*(int2048, long long);
+  friend int2048 operator*(long long, int2048);
+  friend int2048 operator/(int2048, long long);
+  friend int2048 operator%(int2048, long long);
+
+  // base^exp mod m, in [0, m) for m > 0 and (m, 0] for m < 0; exp must be non-negative
+  friend int2048 powmod(const int2048 &base, const int2048 &exp, const int2048 &mod);
+
+  // A fixed divisor prepared once for repeated division, defined below
+  class divisor;
 
   friend std::istream &operator>>(std::istream &, int2048 &);
   friend std::ostream &operator<<(std::ostream &, const int2048 &);
@@ -98,6 +266,217 @@ public:
   friend bool operator>(const int2048 &, const int2048 &);
   friend bool operator<=(const int2048 &, const int2048 &);
   friend bool operator>=(const int2048 &, const int2048 &);
+  friend bool operator==(const int2048 &, long long);
+  friend bool operator!=(const int2048 &, long long);
+  friend bool operator<(const int2048 &, long long);
+  friend bool operator>(const int2048 &, long long);
+  friend bool operator<=(const int2048 &, long long);
+  friend bool operator>=(const int2048 &, long long);
+  friend bool operator==(long long, const int2048 &);
+  friend bool operator!=(long long, const int2048 &);
+  friend bool operator<(long long, const int2048 &);
+  friend bool operator>(long long, const int2048 &);
+  friend bool operator<=(long long, const int2048 &);
+  friend bool operator>=(long long, const int2048 &);
+};
+
+// A fixed divisor prepared once for repeated division: large divisors keep their
+// normalized limbs and a reciprocal, so each reduction of a dividend up to twice the
+// divisor's length costs a couple of multiplications. Same floor semantics as divmod.
+class int2048::divisor {
+public:
+  explicit divisor(const int2048 &);
+
+  const int2048 &value() const;
+  int2048 div(const int2048 &) const;
+  int2048 mod(const int2048 &) const;
+  // q and r may alias a
+  void divmod(const int2048 &a, int2048 &q, int2048 &r) const;
+
+private:
+  int2048 d_;
+  int norm_;
+  limb_vector b_;   // |d| * norm_, top limb at least BASE / 2
+  limb_vector inv_; // reciprocal_vec(b_), empty when d_ takes the plain path
+};
+
+// Signed big integer on full 32-bit binary limbs: 2.4 times denser than int2048, and
+// addition, subtraction and multiplication never touch a decimal carry. Decimal only
+// appears at the text and int2048 boundaries, converted divide-and-conquer with the
+// fast multipliers. The limbs are a plain std::vector<unsigned>, so values and kernel
+// results use the global allocator rather than the scratch arena or an
+// int2048_resource_scope; only the transform buffers go through those.
+class int2048_bin {
+private:
+  // sign_: 1 (positive), -1 (negative), 0 (zero)
+  int sign_;
+  std::vector<unsigned> a_; // little-endian 32-bit limbs
+
+  void trim();
+  int2048_bin &add_signed(const int2048_bin &, int rhs_sign);
+
+  static std::vector<unsigned> multiply_fft(const std::vector<unsigned> &, const std::vector<unsigned> &);
+  static std::vector<unsigned> multiply_vec(const std::vector<unsigned> &, const std::vector<unsigned> &);
+
+  static std::vector<unsigned> from_base10000(const int *, std::size_t);
+  static limb_vector to_base10000(const unsigned *, std::size_t);
+  static const std::vector<unsigned> &pow10000(std::size_t k);      // 10000^(2^k) in 32-bit limbs
+  static const limb_vector &pow2_base10000(std::size_t k); // 2^(32 * 2^k) in base 10000
+
+public:
+  int2048_bin();
+  int2048_bin(long long);
+  explicit int2048_bin(const std::string &);
+  explicit int2048_bin(const int2048 &);
+
+  int2048 to_int2048() const;
+
+  void read(const std::string &);
+  void print();
+
+  int2048_bin operator+() const;
+  int2048_bin operator-() const;
+
+  int2048_bin &operator+=(const int2048_bin &);
+  friend int2048_bin operator+(int2048_bin, const int2048_bin &);
+
+  int2048_bin &operator-=(const int2048_bin &);
+  friend int2048_bin operator-(int2048_bin, const int2048_bin &);
+
+  int2048_bin &operator*=(const int2048_bin &);
+  friend int2048_bin operator*(int2048_bin, const int2048_bin &);
+
+  friend std::istream &operator>>(std::istream &, int2048_bin &);
+  friend std::ostream &operator<<(std::ostream &, const int2048_bin &);
+
+  friend bool operator==(const int2048_bin &, const int2048_bin &);
+  friend bool operator!=(const int2048_bin &, const int2048_bin &);
+  friend bool operator<(const int2048_bin &, const int2048_bin &);
+  friend bool operator>(const int2048_bin &, const int2048_bin &);
+  friend bool operator<=(const int2048_bin &, const int2048_bin &);
+  friend bool operator>=(const int2048_bin &, const int2048_bin &);
+};
+
+// Token reader for bulk inputs: the stream is pulled in large chunks and every
+// whitespace-separated token is parsed in place, without a std::string per token. Reads
+// return false once the input is exhausted.
+class int2048_reader {
+public:
+  explicit int2048_reader(std::istream &, std::size_t chunk = 1 << 16);
+
+  bool read(int2048 &);
+  bool read(long long &);
+
+private:
+  // [first, last) of the next token, valid until the next call
+  bool next_token(const char *&first, const char *&last);
+  bool refill();
+
+  std::streambuf *sb_;
+  std::vector<char> buf_;
+  std::size_t pos_, end_;
+  std::string carry_; // a token that straddles two chunks
+};
+
+// Read-only view of a serialized int2048 in place, e.g. inside a memory-mapped file. The
+// limbs are only decoded on access, byte-swapped when the record came from a host of the
+// other endianness. The view checks the header alone: limb() and to_int2048() return the
+// stored limbs unvalidated, so untrusted records go through int2048::deserialize, which
+// also rejects limbs of 10000 and above.
+class int2048_view {
+public:
+  int2048_view();
+  // Checks the header and the length against [first, last); an invalid view has size 0.
+  int2048_view(const char *first, const char *last);
+
+  bool valid() const;
+  int sign() const;
+  std::size_t limb_count() const;
+  int limb(std::size_t) const; // little-endian base-10000 limbs
+  std::size_t byte_size() const; // length of the record
+  int2048 to_int2048() const;
+
+private:
+  const char *data_;
+  bool swap_;
+  int sign_;
+  std::size_t limbs_;
+};
+
+// Output batcher: values are formatted into one buffer that is handed to the stream in
+// large writes; the destructor flushes.
+class int2048_writer {
+public:
+  explicit int2048_writer(std::ostream &, std::size_t capacity = 1 << 16);
+  ~int2048_writer();
+
+  int2048_writer &write(const int2048 &);
+  int2048_writer &write(long long);
+  int2048_writer &put(char);
+  void flush();
+
+private:
+  std::ostream &os_;
+  std::vector<char> buf_;
+  std::size_t used_;
+};
+
+// Source of heap memory for int2048 limbs and kernel temporaries, shaped like
+// std::pmr::memory_resource (which this library cannot include). Without a resource in
+// scope, blocks come from a per-thread recycling arena.
+class int2048_memory_resource {
+public:
+  virtual ~int2048_memory_resource();
+
+  void *allocate(std::size_t bytes, std::size_t align);
+  void deallocate(void *p, std::size_t bytes, std::size_t align);
+
+protected:
+  virtual void *do_allocate(std::size_t bytes, std::size_t align) = 0;
+  virtual void do_deallocate(void *p, std::size_t bytes, std::size_t align) = 0;
+};
+
+// While alive, int2048 values and kernel temporaries that this thread constructs take
+// their heap blocks from the given resource (null restores the arena); scopes nest. As
+// with std::pmr, the resource is bound when a value is constructed: values that existed
+// before the scope keep their own memory however they are modified or assigned in it,
+// and moving a value into one bound to another resource copies the limbs (running out
+// of memory there terminates, as the move is noexcept). swap never allocates, so it
+// exchanges the resources together with the blocks. Values constructed in the scope, or
+// swapped with one, must not outlive the resource; the library's per-thread conversion
+// caches are always built from the arena.
+class int2048_resource_scope {
+public:
+  explicit int2048_resource_scope(int2048_memory_resource *);
+  ~int2048_resource_scope();
+
+  int2048_resource_scope(const int2048_resource_scope &) = delete;
+  int2048_resource_scope &operator=(const int2048_resource_scope &) = delete;
+
+private:
+  int2048_memory_resource *previous_;
+};
+
+// Bump allocation from chunks of doubling size. deallocate does nothing; release() and
+// the destructor free all chunks at once, e.g. at the end of a request.
+class int2048_monotonic_resource : public int2048_memory_resource {
+public:
+  explicit int2048_monotonic_resource(std::size_t initial_chunk = 1 << 16);
+  ~int2048_monotonic_resource();
+
+  int2048_monotonic_resource(const int2048_monotonic_resource &) = delete;
+  int2048_monotonic_resource &operator=(const int2048_monotonic_resource &) = delete;
+
+  void release();
+
+protected:
+  void *do_allocate(std::size_t bytes, std::size_t align) override;
+  void do_deallocate(void *p, std::size_t bytes, std::size_t align) override;
+
+private:
+  char *chunks_; // newest first
+  char *cur_, *end_;
+  std::size_t next_chunk_;
 };
 } // namespace sjtu
 
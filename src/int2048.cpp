@@ -6,10 +6,199 @@ namespace {
 
 const int LOCAL_BASE = 10000;
 
-std::vector<int> mul_vec_int(const std::vector<int> &a, int m) {
+// Multiplication tiers, in limbs of the shorter operand. Inside the recursive tier,
+// blocks below KARATSUBA_THRESHOLD fall back to the quadratic base case.
+const std::size_t SCHOOLBOOK_THRESHOLD = 8;
+const std::size_t KARATSUBA_THRESHOLD = 32;
+const std::size_t TOOM3_THRESHOLD = 160;
+const std::size_t FFT_THRESHOLD = 768;
+
+// Operands of at most WORD_LIMBS limbs (below 10^16) are added, multiplied and divided as
+// machine words, falling back to the limb kernels when a product overflows 64 bits. Every
+// 64-bit magnitude fits in U64_LIMBS limbs.
+const std::size_t WORD_LIMBS = 4;
+const std::size_t U64_LIMBS = 5;
+
+// The double-precision FFT keeps full base-10000 limbs up to FFT_SPLIT_THRESHOLD limbs of
+// the shorter operand. Products whose rounding error exceeds FFT_MAX_ERROR are redone
+// with the exact NTT.
+const std::size_t FFT_SPLIT_THRESHOLD = 32768;
+const double FFT_MAX_ERROR = 0.2;
+
+// Division switches from schoolbook to Newton reciprocal iteration once both the divisor
+// and the quotient reach NEWTON_THRESHOLD limbs. Reciprocals of at most NEWTON_BASECASE
+// limbs are computed directly; truncated divisors keep NEWTON_GUARD extra limbs.
+const std::size_t NEWTON_THRESHOLD = 50;
+const std::size_t NEWTON_BASECASE = 32;
+const std::size_t NEWTON_GUARD = 2;
+
+// A prepared int2048::divisor keeps a reciprocal from DIVISOR_RECIPROCAL_THRESHOLD limbs
+// on; shorter divisors are cheaper to divide by from scratch.
+const std::size_t DIVISOR_RECIPROCAL_THRESHOLD = 32;
+
+// Montgomery reduction runs word by word below MONTGOMERY_REDC_THRESHOLD limbs of the
+// modulus and by two multiplications with a precomputed -m^-1 mod R from there on.
+const std::size_t MONTGOMERY_REDC_THRESHOLD = 160;
+
+// int2048_bin multiplies 32-bit limbs by schoolbook below BIN_KARATSUBA_THRESHOLD limbs of
+// the shorter operand and by the packed FFT from BIN_FFT_THRESHOLD on, with Karatsuba in
+// between. The FFT cuts the bits into the widest digits (16 bits at most) for which the
+// shorter operand's digit count times the squared digit bound stays below
+// 2^BIN_FFT_COEFF_BITS, about what the decimal FFT allows before it splits. Radix
+// conversion recurses down to blocks of at most BIN_CONVERT_THRESHOLD limbs, which are
+// converted by Horner's rule.
+const std::size_t BIN_KARATSUBA_THRESHOLD = 40;
+const std::size_t BIN_FFT_THRESHOLD = 800;
+const std::size_t BIN_FFT_COEFF_BITS = 42;
+const std::size_t BIN_CONVERT_THRESHOLD = 32;
+
+// Text in other radices is cut into chunks of as many digits as fit below RADIX_CHUNK_LIMIT;
+// blocks of at most RADIX_BASECASE_CHUNKS chunks are converted one chunk at a time.
+const long long RADIX_CHUNK_LIMIT = 1000000000;
+const std::size_t RADIX_BASECASE_CHUNKS = 32;
+
+const char RADIX_DIGITS[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+
+// Serialized records start with SERIAL_MAGIC and carry their own byte order, see
+// int2048::serialize.
+const char SERIAL_MAGIC[] = "i2k";
+const unsigned short SERIAL_ENDIAN_MARKER = 0x0102;
+const std::size_t SERIAL_HEADER_SIZE = 16;
+
+// Heap blocks for limbs and kernel temporaries come in power-of-two size classes from
+// 2^SCRATCH_MIN_CLASS bytes up; each thread keeps up to SCRATCH_BLOCKS_PER_CLASS freed
+// blocks per class for reuse, so steady-state arithmetic stops calling the allocator.
+const std::size_t SCRATCH_MIN_CLASS = 6;
+const std::size_t SCRATCH_CLASSES = 48;
+const std::size_t SCRATCH_BLOCKS_PER_CLASS = 8;
+
+// int2048_monotonic_resource links its chunks through their first bytes
+const std::size_t MONOTONIC_CHUNK_HEADER = 16;
+
+// Trivially destructible so that blocks released by other thread-local or static
+// objects during shutdown still find it; scratch_guard empties it first.
+struct scratch_arena {
+  void *blocks[SCRATCH_CLASSES][SCRATCH_BLOCKS_PER_CLASS];
+  unsigned char count[SCRATCH_CLASSES];
+  bool guarded, closed;
+  int2048_memory_resource *resource; // of the innermost int2048_resource_scope
+};
+
+thread_local scratch_arena thread_scratch;
+
+struct scratch_guard {
+  ~scratch_guard() {
+    scratch_arena &arena = thread_scratch;
+    for (std::size_t c = 0; c < SCRATCH_CLASSES; ++c)
+      while (arena.count[c] > 0)
+        ::operator delete(arena.blocks[c][--arena.count[c]]);
+    arena.closed = true;
+  }
+};
+
+std::size_t scratch_class(std::size_t bytes) {
+  std::size_t c = SCRATCH_MIN_CLASS;
+  while ((std::size_t(1) << c) < bytes)
+    ++c;
+  return c;
+}
+
+// A block of at least `bytes` bytes from `source`, or from the arena if it is null, in
+// which case `bytes` is raised to the block's full size
+void *scratch_acquire(std::size_t &bytes, int2048_memory_resource *source) {
+  if (source != nullptr)
+    return source->allocate(bytes, 16);
+  const std::size_t c = scratch_class(bytes);
+  bytes = std::size_t(1) << c;
+  scratch_arena &arena = thread_scratch;
+  if (arena.count[c] > 0)
+    return arena.blocks[c][--arena.count[c]];
+  return ::operator new(bytes);
+}
+
+// Takes back a block acquired for `bytes` bytes from `source`, by this or any other thread
+void scratch_release(void *p, std::size_t bytes, int2048_memory_resource *source) {
+  if (source != nullptr) {
+    source->deallocate(p, bytes, 16);
+    return;
+  }
+  const std::size_t c = scratch_class(bytes);
+  scratch_arena &arena = thread_scratch;
+  if (!arena.guarded) {
+    thread_local scratch_guard guard;
+    arena.guarded = true;
+  }
+  if (arena.closed || arena.count[c] == SCRATCH_BLOCKS_PER_CLASS) {
+    ::operator delete(p);
+    return;
+  }
+  arena.blocks[c][arena.count[c]++] = p;
+}
+
+// Routes the kernels' std::vector temporaries through the resource in scope at their
+// construction, or the arena
+template <class T> struct scratch_allocator {
+  typedef T value_type;
+  int2048_memory_resource *resource;
+  scratch_allocator() : resource(thread_scratch.resource) {}
+  template <class U> scratch_allocator(const scratch_allocator<U> &other) : resource(other.resource) {}
+  T *allocate(std::size_t n) {
+    std::size_t bytes = n * sizeof(T);
+    return static_cast<T *>(scratch_acquire(bytes, resource));
+  }
+  void deallocate(T *p, std::size_t n) { scratch_release(p, n * sizeof(T), resource); }
+};
+
+template <class T, class U> bool operator==(const scratch_allocator<T> &lhs, const scratch_allocator<U> &rhs) {
+  return lhs.resource == rhs.resource;
+}
+
+template <class T, class U> bool operator!=(const scratch_allocator<T> &lhs, const scratch_allocator<U> &rhs) {
+  return lhs.resource != rhs.resource;
+}
+
+template <class T> using scratch_vector = std::vector<T, scratch_allocator<T>>;
+
+// Per-length FFT tables. roots[half + j] = exp(2 pi i j / (2 half)), so one table
+// serves every butterfly level; each entry comes straight from std::polar instead
+// of a running product, which keeps the twiddle error independent of the length.
+struct fft_plan {
+  std::vector<std::size_t> rev;
+  std::vector<std::complex<double>> roots;
+};
+
+// Plans are cached per thread and per power-of-two length, so concurrent
+// multiplications never share mutable state.
+const fft_plan &get_fft_plan(std::size_t n) {
+  thread_local std::vector<fft_plan> plans;
+  std::size_t log_n = 0;
+  while ((std::size_t(1) << log_n) < n)
+    ++log_n;
+  if (plans.size() <= log_n)
+    plans.resize(log_n + 1);
+
+  fft_plan &plan = plans[log_n];
+  if (plan.rev.size() != n) {
+    plan.rev.assign(n, 0);
+    for (std::size_t i = 1; i < n; ++i)
+      plan.rev[i] = (plan.rev[i >> 1] >> 1) | ((i & 1) ? n >> 1 : 0);
+
+    const long double PI = 3.141592653589793238462643383279502884L;
+    plan.roots.assign(n < 2 ? 2 : n, std::complex<double>(1.0, 0.0));
+    for (std::size_t half = 1; half < n; half <<= 1) {
+      for (std::size_t j = 0; j < half; ++j) {
+        std::complex<long double> w = std::polar(1.0L, PI * j / half);
+        plan.roots[half + j] = std::complex<double>(double(w.real()), double(w.imag()));
+      }
+    }
+  }
+  return plan;
+}
+
+limb_vector mul_vec_int(const limb_vector &a, int m) {
   if (m == 0 || a.empty())
     return {};
-  std::vector<int> res;
+  limb_vector res;
   res.resize(a.size());
   long long carry = 0;
   for (std::size_t i = 0; i < a.size(); ++i) {
@@ -26,7 +215,70 @@ std::vector<int> mul_vec_int(const std::vector<int> &a, int m) {
   return res;
 }
 
-int cmp_vec_abs(const std::vector<int> &a, const std::vector<int> &b) {
+// a as a machine word, for a.size() <= WORD_LIMBS
+long long word_of(const limb_vector &a) {
+  long long x = 0;
+  for (std::size_t i = a.size(); i-- > 0;)
+    x = x * LOCAL_BASE + a[i];
+  return x;
+}
+
+void word_to_limbs(unsigned long long x, limb_vector &a) {
+  a.clear();
+  for (; x != 0; x /= LOCAL_BASE)
+    a.push_back(int(x % LOCAL_BASE));
+}
+
+// a as a 128-bit word, for a.size() <= U64_LIMBS
+unsigned __int128 wide_word_of(const limb_vector &a) {
+  unsigned __int128 x = 0;
+  for (std::size_t i = a.size(); i-- > 0;)
+    x = x * LOCAL_BASE + unsigned(a[i]);
+  return x;
+}
+
+unsigned long long word_abs(long long x) { return x < 0 ? 0ull - (unsigned long long)x : (unsigned long long)x; }
+
+int word_sign(long long x) { return x < 0 ? -1 : (x > 0 ? 1 : 0); }
+
+// a += m
+void add_word_inplace(limb_vector &a, unsigned long long m) {
+  for (std::size_t i = 0; m != 0; ++i) {
+    if (i == a.size())
+      a.push_back(0);
+    m += unsigned(a[i]);
+    a[i] = int(m % LOCAL_BASE);
+    m /= LOCAL_BASE;
+  }
+}
+
+// a -= m, assume a > m
+void sub_word_inplace(limb_vector &a, unsigned long long m) {
+  for (std::size_t i = 0; m != 0; ++i) {
+    a[i] -= int(m % LOCAL_BASE);
+    m /= LOCAL_BASE;
+    if (a[i] < 0) {
+      a[i] += LOCAL_BASE;
+      ++m;
+    }
+  }
+  while (!a.empty() && a.back() == 0)
+    a.pop_back();
+}
+
+// a *= m for 0 < m < 2^31
+void mul_vec_int_inplace(limb_vector &a, int m) {
+  long long carry = 0;
+  for (std::size_t i = 0; i < a.size(); ++i) {
+    long long cur = carry + 1ll * a[i] * m;
+    a[i] = int(cur % LOCAL_BASE);
+    carry = cur / LOCAL_BASE;
+  }
+  for (; carry != 0; carry /= LOCAL_BASE)
+    a.push_back(int(carry % LOCAL_BASE));
+}
+
+int cmp_vec_abs(const limb_vector &a, const limb_vector &b) {
   if (a.size() != b.size())
     return a.size() < b.size() ? -1 : 1;
   for (int i = int(a.size()) - 1; i >= 0; --i) {
@@ -36,7 +288,36 @@ int cmp_vec_abs(const std::vector<int> &a, const std::vector<int> &b) {
   return 0;
 }
 
-void div_vec_int_inplace(std::vector<int> &a, int d) {
+void trim_vec(limb_vector &a) {
+  while (!a.empty() && a.back() == 0)
+    a.pop_back();
+}
+
+// a / BASE^k, i.e. a without its k lowest limbs
+limb_vector shifted_down(const limb_vector &a, std::size_t k) {
+  if (k >= a.size())
+    return {};
+  return limb_vector(a.begin() + k, a.end());
+}
+
+// limbs [lo, hi) of a as a trimmed number
+limb_vector limb_slice(const limb_vector &a, std::size_t lo, std::size_t hi) {
+  if (hi > a.size())
+    hi = a.size();
+  if (lo >= hi)
+    return {};
+  limb_vector res(a.begin() + lo, a.begin() + hi);
+  trim_vec(res);
+  return res;
+}
+
+// a * BASE^k
+void shift_up_inplace(limb_vector &a, std::size_t k) {
+  if (!a.empty() && k > 0)
+    a.insert(a.begin(), k, 0);
+}
+
+void div_vec_int_inplace(limb_vector &a, int d) {
   long long rem = 0;
   for (int i = int(a.size()) - 1; i >= 0; --i) {
     long long cur = a[i] + rem * LOCAL_BASE;
@@ -47,376 +328,1671 @@ void div_vec_int_inplace(std::vector<int> &a, int d) {
     a.pop_back();
 }
 
-} // namespace
+// a /= d for 0 < d < 2^64, returning the remainder. Four limbs (below 10^16 < 2^64) are
+// consumed per step by Moller-Granlund 2/1 division with a precomputed reciprocal of the
+// shifted divisor, so the loop needs no hardware divide.
+unsigned long long div_vec_u64_inplace(limb_vector &a, unsigned long long d) {
+  typedef unsigned long long u64;
+  typedef unsigned __int128 u128;
+  const int shift = __builtin_clzll(d);
+  const u64 dn = d << shift;
+  const u64 v = u64(~u128(0) / dn); // floor((2^128 - 1) / dn) - 2^64
+  u64 rem = 0;
+  std::size_t i = a.size();
+  while (i > 0) {
+    const std::size_t g = (i - 1) % 4 + 1;
+    u64 chunk = 0, scale = 1;
+    for (std::size_t k = i; k-- > i - g;) {
+      chunk = chunk * LOCAL_BASE + u64(a[k]);
+      scale *= LOCAL_BASE;
+    }
+    // rem < d, so the numerator is below d * 2^64 and the quotient fits in 64 bits
+    const u128 num = (u128(rem) * scale + chunk) << shift;
+    const u64 u1 = u64(num >> 64), u0 = u64(num);
+    const u128 qq = u128(v) * u1 + ((u128(u1 + 1) << 64) | u0);
+    u64 q1 = u64(qq >> 64);
+    const u64 q0 = u64(qq);
+    u64 r = u0 - q1 * dn;
+    if (r > q0) {
+      --q1;
+      r += dn;
+    }
+    if (r >= dn) {
+      ++q1;
+      r -= dn;
+    }
+    rem = r >> shift;
+    for (std::size_t k = i - g; k < i; ++k) {
+      a[k] = int(q1 % LOCAL_BASE);
+      q1 /= LOCAL_BASE;
+    }
+    i -= g;
+  }
+  while (!a.empty() && a.back() == 0)
+    a.pop_back();
+  return rem;
+}
 
-int2048::int2048() : sign_(0) {}
+// The recursive multipliers work on carry-free polynomial coefficients and only
+// normalize once at the end. Inside the Karatsuba/Toom-3 tier (operands below
+// FFT_THRESHOLD) every intermediate coefficient stays far below 2^63.
+void poly_mul_basecase(const long long *a, const long long *b, std::size_t n, long long *res) {
+  for (std::size_t i = 0; i < 2 * n - 1; ++i)
+    res[i] = 0;
+  for (std::size_t i = 0; i < n; ++i) {
+    if (a[i] == 0)
+      continue;
+    for (std::size_t j = 0; j < n; ++j)
+      res[i + j] += a[i] * b[j];
+  }
+}
 
-int2048::int2048(long long x) : sign_(0) {
-  if (x == 0)
-    return;
-  if (x < 0) {
-    sign_ = -1;
-    x = -x;
-  } else {
-    sign_ = 1;
+void poly_mul(const long long *a, const long long *b, std::size_t n, long long *res);
+
+// Karatsuba recombination, shared by products and squares: res holds the low and high
+// half products at res[0, 2h - 1) and res[2h, 2h + 2l - 1) and zeros elsewhere, mid the
+// product of the half sums; adds the middle term mid - low - high at res + h.
+void karatsuba_combine(long long *mid, std::size_t h, std::size_t l, long long *res) {
+  for (std::size_t i = 0; i < 2 * h - 1; ++i)
+    mid[i] -= res[i];
+  for (std::size_t i = 0; i < 2 * l - 1; ++i)
+    mid[i] -= res[2 * h + i];
+  for (std::size_t i = 0; i < 2 * h - 1; ++i)
+    res[h + i] += mid[i];
+}
+
+// Toom-3 interpolation with Bodrato's sequence, shared by products and squares. res
+// holds r0 = v(0) at res[0, 2k - 1) and r_inf at res[4k, 4k + 2l - 1), zeros elsewhere;
+// r1, rm1 and rm2 hold v(1), v(-1) and v(-2), 2k - 1 coefficients each, and are
+// overwritten. The divisions by 2 and 3 are exact on the coefficients.
+void toom3_interpolate(long long *r1, long long *rm1, long long *rm2, std::size_t k, std::size_t l, long long *res) {
+  const std::size_t len = 2 * k - 1;
+  const std::size_t inf_len = 2 * l - 1;
+  const long long *r0 = res, *rinf = res + 4 * k;
+  for (std::size_t i = 0; i < len; ++i) {
+    long long vinf = i < inf_len ? rinf[i] : 0;
+    long long c3 = (rm2[i] - r1[i]) / 3;
+    long long c1 = (r1[i] - rm1[i]) / 2;
+    long long c2 = rm1[i] - r0[i];
+    c3 = (c2 - c3) / 2 + 2 * vinf;
+    c2 = c2 + c1 - vinf;
+    c1 = c1 - c3;
+    r1[i] = c1;
+    rm1[i] = c2;
+    rm2[i] = c3;
   }
-  while (x) {
-    a_.push_back(int(x % BASE));
-    x /= BASE;
+  for (std::size_t i = 0; i < len; ++i) {
+    res[k + i] += r1[i];
+    res[2 * k + i] += rm1[i];
+    res[3 * k + i] += rm2[i];
   }
 }
 
-int2048::int2048(const std::string &s) : sign_(0) { read(s); }
+// res[0, 2n - 1) = a * b with a = a0 + a1 x^h, b = b0 + b1 x^h
+void poly_mul_karatsuba(const long long *a, const long long *b, std::size_t n, long long *res) {
+  const std::size_t h = (n + 1) / 2;
+  const std::size_t l = n - h;
+  scratch_vector<long long> sum(2 * h), mid(2 * h - 1);
+  for (std::size_t i = 0; i < h; ++i) {
+    sum[i] = a[i] + (i < l ? a[h + i] : 0);
+    sum[h + i] = b[i] + (i < l ? b[h + i] : 0);
+  }
+  poly_mul(sum.data(), sum.data() + h, h, mid.data());
 
-int2048::int2048(const int2048 &other) : sign_(other.sign_), a_(other.a_) {}
+  for (std::size_t i = 0; i < 2 * n - 1; ++i)
+    res[i] = 0;
+  poly_mul(a, b, h, res);
+  poly_mul(a + h, b + h, l, res + 2 * h);
+  karatsuba_combine(mid.data(), h, l, res);
+}
 
-void int2048::trim() {
-  while (!a_.empty() && a_.back() == 0)
-    a_.pop_back();
-  if (a_.empty())
-    sign_ = 0;
+// Toom-Cook 3-way: evaluate at 0, 1, -1, -2 and infinity, then interpolate.
+void poly_mul_toom3(const long long *a, const long long *b, std::size_t n, long long *res) {
+  const std::size_t k = (n + 2) / 3;
+  const std::size_t l = n - 2 * k;
+  const std::size_t len = 2 * k - 1;
+
+  scratch_vector<long long> ev(8 * k);
+  long long *a1 = ev.data(), *am1 = a1 + k, *am2 = am1 + k, *b1 = am2 + k;
+  long long *bm1 = b1 + k, *bm2 = bm1 + k;
+  for (std::size_t i = 0; i < k; ++i) {
+    long long x0 = a[i], x1 = a[k + i], x2 = i < l ? a[2 * k + i] : 0;
+    long long y0 = b[i], y1 = b[k + i], y2 = i < l ? b[2 * k + i] : 0;
+    a1[i] = x0 + x1 + x2;
+    am1[i] = x0 - x1 + x2;
+    am2[i] = x0 - 2 * x1 + 4 * x2;
+    b1[i] = y0 + y1 + y2;
+    bm1[i] = y0 - y1 + y2;
+    bm2[i] = y0 - 2 * y1 + 4 * y2;
+  }
+
+  scratch_vector<long long> prod(3 * len);
+  long long *r1 = prod.data(), *rm1 = r1 + len, *rm2 = rm1 + len;
+  poly_mul(a1, b1, k, r1);
+  poly_mul(am1, bm1, k, rm1);
+  poly_mul(am2, bm2, k, rm2);
+
+  // r0 and r_inf are computed straight into their final positions
+  for (std::size_t i = 0; i < 2 * n - 1; ++i)
+    res[i] = 0;
+  poly_mul(a, b, k, res);
+  poly_mul(a + 2 * k, b + 2 * k, l, res + 4 * k);
+  toom3_interpolate(r1, rm1, rm2, k, l, res);
 }
 
-int int2048::abs_compare(const int2048 &lhs, const int2048 &rhs) {
-  if (lhs.a_.size() != rhs.a_.size())
-    return lhs.a_.size() < rhs.a_.size() ? -1 : 1;
-  for (int i = int(lhs.a_.size()) - 1; i >= 0; --i) {
-    if (lhs.a_[i] != rhs.a_[i])
-      return lhs.a_[i] < rhs.a_[i] ? -1 : 1;
+void poly_mul(const long long *a, const long long *b, std::size_t n, long long *res) {
+  if (n < KARATSUBA_THRESHOLD)
+    poly_mul_basecase(a, b, n, res);
+  else if (n < TOOM3_THRESHOLD)
+    poly_mul_karatsuba(a, b, n, res);
+  else
+    poly_mul_toom3(a, b, n, res);
+}
+
+// Squaring counterparts of the kernels above: the base case forms each cross
+// product once, Karatsuba and Toom-3 evaluate one operand and recurse on squares only.
+void poly_sqr_basecase(const long long *a, std::size_t n, long long *res) {
+  for (std::size_t i = 0; i < 2 * n - 1; ++i)
+    res[i] = 0;
+  for (std::size_t i = 0; i < n; ++i) {
+    if (a[i] == 0)
+      continue;
+    long long twice = 2 * a[i];
+    for (std::size_t j = i + 1; j < n; ++j)
+      res[i + j] += twice * a[j];
+    res[2 * i] += a[i] * a[i];
   }
-  return 0;
 }
 
-std::vector<int> int2048::abs_add_vec(const std::vector<int> &lhs, const std::vector<int> &rhs) {
-  std::size_t n = lhs.size() > rhs.size() ? lhs.size() : rhs.size();
-  std::vector<int> res;
-  res.resize(n);
-  int carry = 0;
+void poly_sqr(const long long *a, std::size_t n, long long *res);
+
+void poly_sqr_karatsuba(const long long *a, std::size_t n, long long *res) {
+  const std::size_t h = (n + 1) / 2;
+  const std::size_t l = n - h;
+  scratch_vector<long long> sum(h), mid(2 * h - 1);
+  for (std::size_t i = 0; i < h; ++i)
+    sum[i] = a[i] + (i < l ? a[h + i] : 0);
+  poly_sqr(sum.data(), h, mid.data());
+
+  for (std::size_t i = 0; i < 2 * n - 1; ++i)
+    res[i] = 0;
+  poly_sqr(a, h, res);
+  poly_sqr(a + h, l, res + 2 * h);
+  karatsuba_combine(mid.data(), h, l, res);
+}
+
+void poly_sqr_toom3(const long long *a, std::size_t n, long long *res) {
+  const std::size_t k = (n + 2) / 3;
+  const std::size_t l = n - 2 * k;
+  const std::size_t len = 2 * k - 1;
+
+  scratch_vector<long long> ev(3 * k);
+  long long *a1 = ev.data(), *am1 = a1 + k, *am2 = am1 + k;
+  for (std::size_t i = 0; i < k; ++i) {
+    long long x0 = a[i], x1 = a[k + i], x2 = i < l ? a[2 * k + i] : 0;
+    a1[i] = x0 + x1 + x2;
+    am1[i] = x0 - x1 + x2;
+    am2[i] = x0 - 2 * x1 + 4 * x2;
+  }
+
+  scratch_vector<long long> prod(3 * len);
+  long long *r1 = prod.data(), *rm1 = r1 + len, *rm2 = rm1 + len;
+  poly_sqr(a1, k, r1);
+  poly_sqr(am1, k, rm1);
+  poly_sqr(am2, k, rm2);
+
+  for (std::size_t i = 0; i < 2 * n - 1; ++i)
+    res[i] = 0;
+  poly_sqr(a, k, res);
+  poly_sqr(a + 2 * k, l, res + 4 * k);
+  toom3_interpolate(r1, rm1, rm2, k, l, res);
+}
+
+void poly_sqr(const long long *a, std::size_t n, long long *res) {
+  if (n < KARATSUBA_THRESHOLD)
+    poly_sqr_basecase(a, n, res);
+  else if (n < TOOM3_THRESHOLD)
+    poly_sqr_karatsuba(a, n, res);
+  else
+    poly_sqr_toom3(a, n, res);
+}
+
+// Normalizes non-negative coefficients into trimmed base-10000 limbs.
+limb_vector carry_coefficients(const long long *c, std::size_t n) {
+  limb_vector res(n, 0);
+  long long carry = 0;
   for (std::size_t i = 0; i < n; ++i) {
-    int cur = carry;
-    if (i < lhs.size())
-      cur += lhs[i];
-    if (i < rhs.size())
-      cur += rhs[i];
-    if (cur >= BASE) {
-      cur -= BASE;
-      carry = 1;
-    } else {
-      carry = 0;
-    }
-    res[i] = cur;
+    long long cur = c[i] + carry;
+    res[i] = int(cur % LOCAL_BASE);
+    carry = cur / LOCAL_BASE;
   }
-  if (carry)
-    res.push_back(carry);
+  while (carry) {
+    res.push_back(int(carry % LOCAL_BASE));
+    carry /= LOCAL_BASE;
+  }
+  while (!res.empty() && res.back() == 0)
+    res.pop_back();
   return res;
 }
 
-std::vector<int> int2048::abs_sub_vec(const std::vector<int> &lhs, const std::vector<int> &rhs) {
-  std::vector<int> res;
-  res.resize(lhs.size());
-  int carry = 0;
-  for (std::size_t i = 0; i < lhs.size(); ++i) {
-    int cur = lhs[i] - carry - (i < rhs.size() ? rhs[i] : 0);
-    if (cur < 0) {
-      cur += BASE;
-      carry = 1;
-    } else {
-      carry = 0;
-    }
-    res[i] = cur;
+// Rounds len transform outputs, given by coef(i), to integers and carries them into
+// base-10000 limbs (pairs of base-100 digits when split). Returns false, leaving res
+// unspecified, if some output is too far from an integer to be trusted.
+template <class Coefficient>
+bool round_fft_result(Coefficient coef, std::size_t len, bool split, limb_vector &res) {
+  const int radix = split ? 100 : LOCAL_BASE;
+  limb_vector digits(len, 0);
+  long long carry = 0;
+  double max_error = 0;
+  for (std::size_t i = 0; i < len; ++i) {
+    double x = coef(i);
+    long long v = (long long)std::floor(x + 0.5);
+    double error = std::fabs(x - double(v));
+    if (error > max_error)
+      max_error = error;
+    long long cur = v + carry;
+    digits[i] = int(cur % radix);
+    carry = cur / radix;
+  }
+  if (max_error > FFT_MAX_ERROR)
+    return false;
+
+  if (split) {
+    res.resize(len / 2);
+    for (std::size_t i = 0; i < res.size(); ++i)
+      res[i] = digits[2 * i] + 100 * digits[2 * i + 1];
+  } else {
+    res.swap(digits);
+  }
+  while (carry) {
+    res.push_back(int(carry % LOCAL_BASE));
+    carry /= LOCAL_BASE;
   }
   while (!res.empty() && res.back() == 0)
     res.pop_back();
-  return res;
+  return true;
 }
 
-void int2048::fft(std::vector<std::complex<long double>> &a, bool invert) {
-  int n = int(a.size());
-  for (int i = 1, j = 0; i < n; ++i) {
-    int bit = n >> 1;
+// Number-theoretic transform over the three NTT-friendly primes below; all of them
+// have 3 as a primitive root and support power-of-two lengths up to NTT_MAX_LENGTH.
+const unsigned NTT_MOD1 = 998244353;
+const unsigned NTT_MOD2 = 167772161;
+const unsigned NTT_MOD3 = 469762049;
+const unsigned NTT_ROOT = 3;
+const std::size_t NTT_MAX_LENGTH = std::size_t(1) << 23;
+
+thread_local int2048::multiply_backend current_backend = int2048::multiply_backend::fft;
+
+unsigned pow_mod(unsigned long long b, unsigned long long e, unsigned mod) {
+  unsigned long long res = 1;
+  b %= mod;
+  while (e) {
+    if (e & 1)
+      res = res * b % mod;
+    b = b * b % mod;
+    e >>= 1;
+  }
+  return unsigned(res);
+}
+
+template <unsigned MOD> void ntt(scratch_vector<unsigned> &a, bool invert) {
+  const std::size_t n = a.size();
+  for (std::size_t i = 1, j = 0; i < n; ++i) {
+    std::size_t bit = n >> 1;
     for (; j & bit; bit >>= 1)
       j ^= bit;
     j ^= bit;
     if (i < j) {
-      std::complex<long double> tmp = a[i];
+      unsigned tmp = a[i];
       a[i] = a[j];
       a[j] = tmp;
     }
   }
 
-  const long double PI = 3.141592653589793238462643383279502884L;
-  for (int len = 2; len <= n; len <<= 1) {
-    long double ang = 2.0L * PI / len * (invert ? -1.0L : 1.0L);
-    std::complex<long double> wlen = std::polar(1.0L, ang);
-    for (int i = 0; i < n; i += len) {
-      std::complex<long double> w(1.0L, 0.0L);
-      int half = len >> 1;
-      for (int j = 0; j < half; ++j) {
-        std::complex<long double> u = a[i + j];
-        std::complex<long double> v = a[i + j + half] * w;
-        a[i + j] = u + v;
-        a[i + j + half] = u - v;
-        w *= wlen;
+  for (std::size_t len = 2; len <= n; len <<= 1) {
+    unsigned wlen = pow_mod(NTT_ROOT, (MOD - 1) / len, MOD);
+    if (invert)
+      wlen = pow_mod(wlen, MOD - 2, MOD);
+    const std::size_t half = len >> 1;
+    for (std::size_t i = 0; i < n; i += len) {
+      unsigned long long w = 1;
+      for (std::size_t j = 0; j < half; ++j) {
+        unsigned u = a[i + j];
+        unsigned v = unsigned(a[i + j + half] * w % MOD);
+        a[i + j] = u + v >= MOD ? u + v - MOD : u + v;
+        a[i + j + half] = u >= v ? u - v : u + MOD - v;
+        w = w * wlen % MOD;
       }
     }
   }
 
   if (invert) {
-    for (int i = 0; i < n; ++i)
-      a[i] /= n;
+    unsigned long long inv_n = pow_mod(n, MOD - 2, MOD);
+    for (std::size_t i = 0; i < n; ++i)
+      a[i] = unsigned(a[i] * inv_n % MOD);
   }
 }
 
-std::vector<int> int2048::multiply_schoolbook(const std::vector<int> &lhs, const std::vector<int> &rhs) {
-  if (lhs.empty() || rhs.empty())
-    return {};
-  std::vector<int> res(lhs.size() + rhs.size(), 0);
-  for (std::size_t i = 0; i < lhs.size(); ++i) {
-    long long carry = 0;
-    for (std::size_t j = 0; j < rhs.size() || carry; ++j) {
-      long long cur = res[i + j] + carry;
-      if (j < rhs.size())
-        cur += 1ll * lhs[i] * rhs[j];
-      res[i + j] = int(cur % BASE);
-      carry = cur / BASE;
-    }
+// Cyclic convolution of lhs[0, ln) and rhs[0, rn) modulo MOD, zero-padded to length
+// n. Passing the same range twice computes its square.
+template <unsigned MOD>
+scratch_vector<unsigned> ntt_convolve_mod(const int *lhs, std::size_t ln, const int *rhs, std::size_t rn,
+                                          std::size_t n) {
+  scratch_vector<unsigned> fa(n, 0);
+  for (std::size_t i = 0; i < ln; ++i)
+    fa[i] = unsigned(lhs[i]);
+  ntt<MOD>(fa, false);
+  if (lhs == rhs && ln == rn) {
+    // squaring needs a single forward transform
+    for (std::size_t i = 0; i < n; ++i)
+      fa[i] = unsigned(1ull * fa[i] * fa[i] % MOD);
+  } else {
+    scratch_vector<unsigned> fb(n, 0);
+    for (std::size_t i = 0; i < rn; ++i)
+      fb[i] = unsigned(rhs[i]);
+    ntt<MOD>(fb, false);
+    for (std::size_t i = 0; i < n; ++i)
+      fa[i] = unsigned(1ull * fa[i] * fb[i] % MOD);
   }
-  while (!res.empty() && res.back() == 0)
-    res.pop_back();
-  return res;
+  ntt<MOD>(fa, true);
+  return fa;
 }
 
-std::vector<int> int2048::multiply_fft(const std::vector<int> &lhs, const std::vector<int> &rhs) {
-  if (lhs.empty() || rhs.empty())
-    return {};
-
+// Exact linear convolution of lhs[0, ln) and rhs[0, rn), which must fit one transform
+// of at most NTT_MAX_LENGTH points. Each coefficient is rebuilt from its three residues
+// with Garner's algorithm; the true value is below 2^64 for any operand length we can
+// hold in memory, so wrapping arithmetic is exact.
+scratch_vector<unsigned long long> ntt_convolve_block(const int *lhs, std::size_t ln, const int *rhs,
+                                                      std::size_t rn) {
+  const std::size_t len = ln + rn - 1;
   std::size_t n = 1;
-  while (n < lhs.size() + rhs.size())
+  while (n < len)
     n <<= 1;
 
-  std::vector<std::complex<long double>> fa(n), fb(n);
-  for (std::size_t i = 0; i < lhs.size(); ++i)
-    fa[i] = std::complex<long double>(lhs[i], 0.0L);
-  for (std::size_t i = 0; i < rhs.size(); ++i)
-    fb[i] = std::complex<long double>(rhs[i], 0.0L);
-
-  fft(fa, false);
-  fft(fb, false);
-  for (std::size_t i = 0; i < n; ++i)
-    fa[i] *= fb[i];
-  fft(fa, true);
+  scratch_vector<unsigned> r1 = ntt_convolve_mod<NTT_MOD1>(lhs, ln, rhs, rn, n);
+  scratch_vector<unsigned> r2 = ntt_convolve_mod<NTT_MOD2>(lhs, ln, rhs, rn, n);
+  scratch_vector<unsigned> r3 = ntt_convolve_mod<NTT_MOD3>(lhs, ln, rhs, rn, n);
+
+  const unsigned long long inv_m1_m2 = pow_mod(NTT_MOD1, NTT_MOD2 - 2, NTT_MOD2);
+  const unsigned long long m1_m2_mod3 = 1ull * NTT_MOD1 * NTT_MOD2 % NTT_MOD3;
+  const unsigned long long inv_m12_m3 = pow_mod(m1_m2_mod3, NTT_MOD3 - 2, NTT_MOD3);
+  const unsigned long long m1_m2 = 1ull * NTT_MOD1 * NTT_MOD2;
+
+  scratch_vector<unsigned long long> res(len);
+  for (std::size_t i = 0; i < len; ++i) {
+    unsigned long long x1 = r1[i];
+    unsigned long long t2 = (r2[i] + NTT_MOD2 - x1 % NTT_MOD2) % NTT_MOD2 * inv_m1_m2 % NTT_MOD2;
+    unsigned long long x12 = x1 + t2 * NTT_MOD1;
+    unsigned long long t3 = (r3[i] + NTT_MOD3 - x12 % NTT_MOD3) % NTT_MOD3 * inv_m12_m3 % NTT_MOD3;
+    res[i] = x12 + t3 * m1_m2;
+  }
+  return res;
+}
 
-  std::vector<int> res(n, 0);
-  long long carry = 0;
-  for (std::size_t i = 0; i < n; ++i) {
-    long long v = (long long)(fa[i].real() + (fa[i].real() >= 0 ? 0.5 : -0.5));
-    long long cur = v + carry;
-    long long digit = cur % BASE;
-    if (digit < 0) {
-      digit += BASE;
-      cur -= BASE;
+// Exact linear convolution of two non-negative digit vectors. Products too long for one
+// transform are cut into blocks of NTT_MAX_LENGTH / 2 digits per operand, whose block
+// products are added in at their offsets; the sums stay as small as the unsplit
+// coefficients. A square convolves each pair of distinct blocks once and doubles it.
+scratch_vector<unsigned long long> ntt_convolve(const limb_vector &lhs, const limb_vector &rhs) {
+  const std::size_t len = lhs.size() + rhs.size() - 1;
+  if (len <= NTT_MAX_LENGTH)
+    return ntt_convolve_block(lhs.data(), lhs.size(), rhs.data(), rhs.size());
+
+  const std::size_t block = NTT_MAX_LENGTH / 2;
+  const bool square = &lhs == &rhs;
+  scratch_vector<unsigned long long> res(len, 0);
+  for (std::size_t i = 0; i < lhs.size(); i += block) {
+    const std::size_t ln = lhs.size() - i < block ? lhs.size() - i : block;
+    for (std::size_t j = square ? i : 0; j < rhs.size(); j += block) {
+      const std::size_t rn = rhs.size() - j < block ? rhs.size() - j : block;
+      scratch_vector<unsigned long long> part = ntt_convolve_block(lhs.data() + i, ln, rhs.data() + j, rn);
+      const unsigned long long times = square && j != i ? 2 : 1;
+      for (std::size_t k = 0; k < part.size(); ++k)
+        res[i + j + k] += times * part[k];
     }
-    res[i] = int(digit);
-    carry = cur / BASE;
-  }
-  while (carry) {
-    int digit = int(carry % BASE);
-    if (digit < 0)
-      digit += BASE;
-    res.push_back(digit);
-    carry /= BASE;
   }
-
-  while (!res.empty() && res.back() == 0)
-    res.pop_back();
   return res;
 }
 
-void int2048::divmod_abs(const int2048 &x, const int2048 &y, int2048 &q, int2048 &r) {
-  // x >= 0, y > 0
-  if (x.sign_ == 0) {
-    q = 0;
-    r = 0;
-    return;
-  }
-  if (abs_compare(x, y) < 0) {
-    q = 0;
-    r = x;
-    return;
+// DIGIT_QUADS[4 v .. 4 v + 4) spells 0 <= v < LOCAL_BASE with leading zeros
+struct digit_quad_table {
+  char text[4 * LOCAL_BASE];
+  digit_quad_table() {
+    for (int v = 0; v < LOCAL_BASE; ++v) {
+      text[4 * v] = char('0' + v / 1000);
+      text[4 * v + 1] = char('0' + v / 100 % 10);
+      text[4 * v + 2] = char('0' + v / 10 % 10);
+      text[4 * v + 3] = char('0' + v % 10);
+    }
   }
+};
+const digit_quad_table DIGIT_QUADS;
+
+// Four digits per limb of a[0, n), from the top limb down
+char *format_quads(const int *a, std::size_t n, char *out) {
+  for (std::size_t i = n; i-- > 0; out += 4)
+    std::memcpy(out, DIGIT_QUADS.text + 4 * a[i], 4);
+  return out;
+}
 
-  int norm = BASE / (y.a_.back() + 1);
-  int2048 a = x;
-  int2048 b = y;
-  if (norm != 1) {
-    a.a_ = mul_vec_int(a.a_, norm);
-    b.a_ = mul_vec_int(b.a_, norm);
-  }
-  a.sign_ = a.a_.empty() ? 0 : 1;
-  b.sign_ = b.a_.empty() ? 0 : 1;
+// SWAR decimal parsing: with the first digit in the lowest byte (little-endian loads), each
+// step merges neighbouring lanes as hi * 10^k + lo.
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+int parse_four_digits(const char *p) {
+  unsigned x;
+  std::memcpy(&x, p, 4);
+  x -= 0x30303030u;
+  x = (x * 10 + (x >> 8)) & 0x00ff00ffu;
+  return int((x * 100 + (x >> 16)) & 0xffffu);
+}
 
-  q.a_.assign(a.a_.size(), 0);
-  q.sign_ = 1;
+// Two limbs at once: the value of p[0, 4) in bits 0..15, of p[4, 8) in bits 32..47
+unsigned long long parse_eight_digits(const char *p) {
+  unsigned long long x;
+  std::memcpy(&x, p, 8);
+  x -= 0x3030303030303030ull;
+  x = (x * 10 + (x >> 8)) & 0x00ff00ff00ff00ffull;
+  return (x * 100 + (x >> 16)) & 0x0000ffff0000ffffull;
+}
+#else
+int parse_four_digits(const char *p) { return ((p[0] - '0') * 10 + (p[1] - '0')) * 100 + (p[2] - '0') * 10 + (p[3] - '0'); }
 
-  const int n = int(a.a_.size());
-  const int bsz = int(b.a_.size());
-  std::vector<int> rv(n + 2, 0); // little-endian remainder window buffer
-  std::vector<int> bd(bsz + 2, 0);
-  int head = n + 1;
-  int len = 0;
+unsigned long long parse_eight_digits(const char *p) {
+  return (unsigned long long)parse_four_digits(p + 4) << 32 | (unsigned long long)parse_four_digits(p);
+}
+#endif
 
-  auto build_bd = [&](int d) -> int {
-    if (d == 0)
-      return 0;
-    long long carry = 0;
-    for (int k = 0; k < bsz; ++k) {
-      long long cur = 1ll * b.a_[k] * d + carry;
-      bd[k] = int(cur % BASE);
-      carry = cur / BASE;
-    }
-    int bd_len = bsz;
-    while (carry) {
-      bd[bd_len++] = int(carry % BASE);
-      carry /= BASE;
-    }
-    while (bd_len > 0 && bd[bd_len - 1] == 0)
-      --bd_len;
-    return bd_len;
-  };
+int radix_digit_value(char c) {
+  if (c <= '9')
+    return c - '0';
+  return c >= 'a' ? c - 'a' + 10 : c - 'A' + 10;
+}
 
-  for (int i = n - 1; i >= 0; --i) {
-    // r = r * BASE + a[i]
-    if (len == 0) {
-      rv[head] = a.a_[i];
-      len = 1;
-    } else {
-      --head;
-      rv[head] = a.a_[i];
-      ++len;
-    }
-    while (len > 0 && rv[head + len - 1] == 0)
-      --len;
-
-    int s1 = (len <= bsz) ? 0 : rv[head + bsz];
-    int s2 = (len <= bsz - 1) ? 0 : rv[head + bsz - 1];
-    int d = int((1ll * BASE * s1 + s2) / b.a_.back());
-    if (d >= BASE)
-      d = BASE - 1;
-
-    int bd_len = build_bd(d);
-
-    auto cmp_r_bd = [&](int rhs_len) -> int {
-      if (len != rhs_len)
-        return len < rhs_len ? -1 : 1;
-      for (int k = len - 1; k >= 0; --k) {
-        int lv = rv[head + k];
-        int rvv = bd[k];
-        if (lv != rvv)
-          return lv < rvv ? -1 : 1;
-      }
-      return 0;
-    };
+// Little-endian 32-bit words of a non-negative limb vector
+std::vector<unsigned> binary_words(limb_vector a) {
+  std::vector<unsigned> res;
+  while (!a.empty())
+    res.push_back(unsigned(div_vec_u64_inplace(a, 1ull << 32)));
+  return res;
+}
 
-    while (cmp_r_bd(bd_len) < 0) {
-      --d;
-      bd_len = build_bd(d);
-    }
+// y with x * y = 1 mod LOCAL_BASE, for x coprime to LOCAL_BASE
+int inverse_mod_base(int x) {
+  int y = 1;
+  while (x * y % LOCAL_BASE != 1)
+    ++y;
+  return y;
+}
 
-    int carry = 0;
-    for (int k = 0; k < bd_len; ++k) {
-      int cur = rv[head + k] - bd[k] - carry;
-      if (cur < 0) {
-        cur += BASE;
-        carry = 1;
-      } else {
-        carry = 0;
-      }
-      rv[head + k] = cur;
+// Left-to-right sliding-window power g^e in a residue ring that provides mul() and sqr()
+// on its own representation of g. e is given as little-endian 32-bit words and must be
+// non-zero; windows of up to k bits use the odd powers g, g^3, ..., g^(2^k - 1).
+template <class Ring>
+limb_vector pow_sliding_window(const Ring &ring, const limb_vector &g, const std::vector<unsigned> &e) {
+  const std::size_t bits = 32 * e.size() - __builtin_clz(e.back());
+  const std::size_t k = bits <= 8 ? 1 : bits <= 24 ? 2 : bits <= 80 ? 3 : bits <= 240 ? 4 : bits <= 672 ? 5 : 6;
+  auto bit = [&](std::size_t i) { return (e[i / 32] >> (i % 32)) & 1u; };
+
+  std::vector<limb_vector> odd(std::size_t(1) << (k - 1));
+  odd[0] = g;
+  if (k > 1) {
+    const limb_vector g2 = ring.sqr(g);
+    for (std::size_t i = 1; i < odd.size(); ++i)
+      odd[i] = ring.mul(odd[i - 1], g2);
+  }
+
+  // the top bit is set, so the first window initializes acc
+  limb_vector acc;
+  bool started = false;
+  for (std::size_t i = bits; i > 0;) {
+    if (!bit(i - 1)) {
+      acc = ring.sqr(acc);
+      --i;
+      continue;
     }
-    for (int k = bd_len; carry && k < len; ++k) {
-      int cur = rv[head + k] - carry;
-      if (cur < 0) {
-        rv[head + k] = cur + BASE;
-        carry = 1;
-      } else {
-        rv[head + k] = cur;
-        carry = 0;
-      }
+    std::size_t lo = i > k ? i - k : 0;
+    while (!bit(lo))
+      ++lo;
+    std::size_t w = 0;
+    for (std::size_t j = i; j-- > lo;)
+      w = w << 1 | bit(j);
+    if (started) {
+      for (std::size_t j = lo; j < i; ++j)
+        acc = ring.sqr(acc);
+      acc = ring.mul(acc, odd[w >> 1]);
+    } else {
+      acc = odd[w >> 1];
+      started = true;
     }
+    i = lo;
+  }
+  return acc;
+}
 
-    while (len > 0 && rv[head + len - 1] == 0)
-      --len;
+// Kernels on little-endian 32-bit limb vectors for int2048_bin; carries and borrows
+// go through 64-bit intermediates.
+void trim_bin(std::vector<unsigned> &a) {
+  while (!a.empty() && a.back() == 0)
+    a.pop_back();
+}
 
-    q.a_[i] = d;
+int cmp_bin(const std::vector<unsigned> &a, const std::vector<unsigned> &b) {
+  if (a.size() != b.size())
+    return a.size() < b.size() ? -1 : 1;
+  for (std::size_t i = a.size(); i-- > 0;) {
+    if (a[i] != b[i])
+      return a[i] < b[i] ? -1 : 1;
   }
+  return 0;
+}
 
-  q.trim();
-  r.a_.clear();
-  if (len > 0) {
-    r.a_.reserve(len);
-    for (int i = 0; i < len; ++i)
-      r.a_.push_back(rv[head + i]);
-  }
-  if (norm != 1)
-    div_vec_int_inplace(r.a_, norm);
-  r.sign_ = r.a_.empty() ? 0 : 1;
+// limbs [lo, hi) of a as a trimmed number
+std::vector<unsigned> slice_bin(const std::vector<unsigned> &a, std::size_t lo, std::size_t hi) {
+  if (hi > a.size())
+    hi = a.size();
+  if (lo >= hi)
+    return {};
+  std::vector<unsigned> res(a.begin() + lo, a.begin() + hi);
+  trim_bin(res);
+  return res;
 }
 
-void int2048::read(const std::string &s) {
-  sign_ = 0;
-  a_.clear();
-  if (s.empty())
+// a += b * 2^(32 off); the carry stops as soon as it dies out
+void add_bin_at(std::vector<unsigned> &a, const std::vector<unsigned> &b, std::size_t off) {
+  if (b.empty())
     return;
-
-  int pos = 0;
-  int sgn = 1;
-  if (s[0] == '-') {
-    sgn = -1;
-    pos = 1;
-  } else if (s[0] == '+') {
-    pos = 1;
+  if (a.size() < off + b.size())
+    a.resize(off + b.size(), 0);
+  unsigned long long carry = 0;
+  std::size_t i = 0;
+  for (; i < b.size(); ++i) {
+    carry += (unsigned long long)a[off + i] + b[i];
+    a[off + i] = unsigned(carry);
+    carry >>= 32;
   }
+  for (i += off; carry && i < a.size(); ++i)
+    carry = ++a[i] == 0;
+  if (carry)
+    a.push_back(1);
+}
 
-  while (pos < int(s.size()) && s[pos] == '0')
-    ++pos;
-  if (pos >= int(s.size())) {
-    sign_ = 0;
-    return;
+// a -= b, assuming a >= b
+void sub_bin(std::vector<unsigned> &a, const std::vector<unsigned> &b) {
+  unsigned long long borrow = 0;
+  std::size_t i = 0;
+  for (; i < b.size(); ++i) {
+    unsigned long long cur = (unsigned long long)a[i] - b[i] - borrow;
+    a[i] = unsigned(cur);
+    borrow = cur >> 63;
   }
+  for (; borrow && i < a.size(); ++i)
+    borrow = a[i]-- == 0;
+  trim_bin(a);
+}
 
-  for (int i = int(s.size()); i > pos; i -= BASE_DIGITS) {
-    int l = i - BASE_DIGITS;
-    if (l < pos)
-      l = pos;
-    int cur = 0;
-    for (int j = l; j < i; ++j)
-      cur = cur * 10 + (s[j] - '0');
-    a_.push_back(cur);
+// a = b - a, assuming b >= a
+void rsub_bin(std::vector<unsigned> &a, const std::vector<unsigned> &b) {
+  const std::size_t n = a.size();
+  a.resize(b.size(), 0);
+  unsigned long long borrow = 0;
+  for (std::size_t i = 0; i < b.size(); ++i) {
+    unsigned long long cur = (unsigned long long)b[i] - (i < n ? a[i] : 0u) - borrow;
+    a[i] = unsigned(cur);
+    borrow = cur >> 63;
   }
-
-  sign_ = sgn;
-  trim();
+  trim_bin(a);
 }
 
-void int2048::print() { std::cout << *this; }
+std::vector<unsigned> mul_bin_basecase(const std::vector<unsigned> &a, const std::vector<unsigned> &b) {
+  std::vector<unsigned> res(a.size() + b.size(), 0);
+  for (std::size_t i = 0; i < a.size(); ++i) {
+    unsigned long long carry = 0;
+    for (std::size_t j = 0; j < b.size(); ++j) {
+      carry += (unsigned long long)a[i] * b[j] + res[i + j];
+      res[i + j] = unsigned(carry);
+      carry >>= 32;
+    }
+    res[i + b.size()] = unsigned(carry);
+  }
+  trim_bin(res);
+  return res;
+}
+
+// Exact fallback for the binary FFT. Every limb is split into two 16-bit digits, so each
+// convolution coefficient stays below 2^55 for any length the NTT supports.
+std::vector<unsigned> mul_bin_ntt(const std::vector<unsigned> &a, const std::vector<unsigned> &b) {
+  auto halves = [](const std::vector<unsigned> &x) {
+    limb_vector d(2 * x.size());
+    for (std::size_t i = 0; i < x.size(); ++i) {
+      d[2 * i] = int(x[i] & 0xffff);
+      d[2 * i + 1] = int(x[i] >> 16);
+    }
+    return d;
+  };
+  scratch_vector<unsigned long long> conv = ntt_convolve(halves(a), halves(b));
+  std::vector<unsigned> res(a.size() + b.size(), 0);
+  unsigned long long carry = 0;
+  for (std::size_t i = 0; i < 2 * res.size(); ++i) {
+    if (i < conv.size())
+      carry += conv[i];
+    res[i / 2] |= unsigned(carry & 0xffff) << (16 * (i & 1));
+    carry >>= 16;
+  }
+  trim_bin(res);
+  return res;
+}
+
+} // namespace
+
+limb_vector::limb_vector() : data_(buf_), size_(0), cap_(INLINE_LIMBS), resource_(thread_scratch.resource) {}
+
+limb_vector::limb_vector(std::size_t n, int value)
+    : data_(buf_), size_(0), cap_(INLINE_LIMBS), resource_(thread_scratch.resource) {
+  resize(n, value);
+}
+
+limb_vector::limb_vector(const int *first, const int *last)
+    : data_(buf_), size_(0), cap_(INLINE_LIMBS), resource_(thread_scratch.resource) {
+  reserve(std::size_t(last - first));
+  std::memcpy(data_, first, std::size_t(last - first) * sizeof(int));
+  size_ = unsigned(last - first);
+}
+
+limb_vector::limb_vector(const limb_vector &other) : limb_vector(other.begin(), other.end()) {}
+
+// Like a std::pmr container, a copy binds the resource in scope and a move keeps the source's
+limb_vector::limb_vector(limb_vector &&other) noexcept
+    : data_(buf_), size_(other.size_), cap_(INLINE_LIMBS), resource_(other.resource_) {
+  if (other.is_inline()) {
+    std::memcpy(buf_, other.buf_, size_ * sizeof(int));
+  } else {
+    data_ = other.data_;
+    cap_ = other.cap_;
+    other.data_ = other.buf_;
+    other.cap_ = INLINE_LIMBS;
+  }
+  other.size_ = 0;
+}
+
+limb_vector::~limb_vector() {
+  if (!is_inline())
+    scratch_release(data_, cap_ * sizeof(int), resource_);
+}
+
+limb_vector &limb_vector::operator=(const limb_vector &other) {
+  if (this != &other) {
+    size_ = 0;
+    reserve(other.size_);
+    std::memcpy(data_, other.data_, other.size_ * sizeof(int));
+    size_ = other.size_;
+  }
+  return *this;
+}
+
+// A block is only taken over from a vector bound to the same resource; otherwise the
+// limbs are copied, so this vector never ends up holding memory of another resource.
+limb_vector &limb_vector::operator=(limb_vector &&other) noexcept {
+  if (this == &other)
+    return *this;
+  if (other.is_inline() || other.resource_ != resource_) {
+    size_ = 0;
+    reserve(other.size_);
+    std::memcpy(data_, other.data_, other.size_ * sizeof(int));
+  } else {
+    if (!is_inline())
+      scratch_release(data_, cap_ * sizeof(int), resource_);
+    data_ = other.data_;
+    cap_ = other.cap_;
+    other.data_ = other.buf_;
+    other.cap_ = INLINE_LIMBS;
+  }
+  size_ = other.size_;
+  other.size_ = 0;
+  return *this;
+}
+
+// Blocks change hands together with their resource, so swapping never allocates
+void limb_vector::swap(limb_vector &other) noexcept {
+  if (this == &other)
+    return;
+  const bool was_inline = is_inline(), other_was_inline = other.is_inline();
+  int buf[INLINE_LIMBS];
+  std::memcpy(buf, buf_, sizeof(buf));
+  std::memcpy(buf_, other.buf_, sizeof(buf));
+  std::memcpy(other.buf_, buf, sizeof(buf));
+  int *data = data_;
+  data_ = other_was_inline ? buf_ : other.data_;
+  other.data_ = was_inline ? other.buf_ : data;
+  unsigned n = size_;
+  size_ = other.size_;
+  other.size_ = n;
+  n = cap_;
+  cap_ = other.cap_;
+  other.cap_ = n;
+  int2048_memory_resource *resource = resource_;
+  resource_ = other.resource_;
+  other.resource_ = resource;
+}
+
+std::size_t limb_vector::size() const { return size_; }
+
+std::size_t limb_vector::capacity() const { return cap_; }
+
+bool limb_vector::empty() const { return size_ == 0; }
+
+int *limb_vector::data() { return data_; }
+
+const int *limb_vector::data() const { return data_; }
+
+int &limb_vector::operator[](std::size_t i) { return data_[i]; }
+
+const int &limb_vector::operator[](std::size_t i) const { return data_[i]; }
+
+int &limb_vector::back() { return data_[size_ - 1]; }
+
+const int &limb_vector::back() const { return data_[size_ - 1]; }
+
+limb_vector::iterator limb_vector::begin() { return data_; }
+
+limb_vector::iterator limb_vector::end() { return data_ + size_; }
+
+limb_vector::const_iterator limb_vector::begin() const { return data_; }
+
+limb_vector::const_iterator limb_vector::end() const { return data_ + size_; }
+
+void limb_vector::push_back(int value) {
+  if (size_ == cap_)
+    reserve(std::size_t(cap_) * 2);
+  data_[size_++] = value;
+}
+
+void limb_vector::pop_back() { --size_; }
+
+void limb_vector::clear() { size_ = 0; }
+
+bool limb_vector::is_inline() const { return data_ == buf_; }
+
+void limb_vector::reserve(std::size_t n) {
+  if (n <= cap_)
+    return;
+  std::size_t bytes = n * sizeof(int);
+  int *block = static_cast<int *>(scratch_acquire(bytes, resource_));
+  std::memcpy(block, data_, size_ * sizeof(int));
+  if (!is_inline())
+    scratch_release(data_, cap_ * sizeof(int), resource_);
+  data_ = block;
+  cap_ = unsigned(bytes / sizeof(int));
+}
+
+void limb_vector::resize(std::size_t n, int value) {
+  if (n > cap_)
+    reserve(n < 2 * std::size_t(cap_) ? 2 * std::size_t(cap_) : n);
+  for (std::size_t i = size_; i < n; ++i)
+    data_[i] = value;
+  size_ = unsigned(n);
+}
+
+void limb_vector::assign(std::size_t n, int value) {
+  size_ = 0;
+  resize(n, value);
+}
+
+limb_vector::iterator limb_vector::open_gap(const_iterator pos, std::size_t n) {
+  const std::size_t at = std::size_t(pos - data_);
+  if (size_ + n > cap_)
+    reserve(size_ + n < 2 * std::size_t(cap_) ? 2 * std::size_t(cap_) : size_ + n);
+  std::memmove(data_ + at + n, data_ + at, (size_ - at) * sizeof(int));
+  size_ += unsigned(n);
+  return data_ + at;
+}
+
+limb_vector::iterator limb_vector::insert(const_iterator pos, std::size_t n, int value) {
+  iterator gap = open_gap(pos, n);
+  for (std::size_t i = 0; i < n; ++i)
+    gap[i] = value;
+  return gap;
+}
+
+// [first, last) must not lie inside this vector
+limb_vector::iterator limb_vector::insert(const_iterator pos, const int *first, const int *last) {
+  iterator gap = open_gap(pos, std::size_t(last - first));
+  std::memcpy(gap, first, std::size_t(last - first) * sizeof(int));
+  return gap;
+}
+
+void int2048::set_multiply_backend(multiply_backend backend) { current_backend = backend; }
+
+int2048::multiply_backend int2048::get_multiply_backend() { return current_backend; }
+
+int2048::int2048() : sign_(0) {}
+
+int2048::int2048(long long x) { assign_word(x); }
+
+int2048::int2048(const std::string &s) : sign_(0) { read(s); }
+
+int2048::int2048(const int2048 &other) : sign_(other.sign_), a_(other.a_) {}
+
+int2048::int2048(int2048 &&other) noexcept : sign_(other.sign_), a_(std::move(other.a_)) {
+  other.sign_ = 0;
+  other.a_.clear();
+}
+
+void int2048::swap(int2048 &other) noexcept {
+  int tmp = sign_;
+  sign_ = other.sign_;
+  other.sign_ = tmp;
+  a_.swap(other.a_);
+}
+
+void swap(int2048 &lhs, int2048 &rhs) noexcept { lhs.swap(rhs); }
+
+int2048 &int2048::assign_word(long long x) {
+  sign_ = word_sign(x);
+  word_to_limbs(word_abs(x), a_);
+  return *this;
+}
+
+void int2048::trim() {
+  while (!a_.empty() && a_.back() == 0)
+    a_.pop_back();
+  if (a_.empty())
+    sign_ = 0;
+}
+
+int int2048::abs_compare(const int2048 &lhs, const int2048 &rhs) {
+  if (lhs.a_.size() != rhs.a_.size())
+    return lhs.a_.size() < rhs.a_.size() ? -1 : 1;
+  for (int i = int(lhs.a_.size()) - 1; i >= 0; --i) {
+    if (lhs.a_[i] != rhs.a_[i])
+      return lhs.a_[i] < rhs.a_[i] ? -1 : 1;
+  }
+  return 0;
+}
+
+void int2048::abs_add_inplace(limb_vector &lhs, const limb_vector &rhs) {
+  if (lhs.size() < rhs.size())
+    lhs.resize(rhs.size(), 0);
+  int carry = 0;
+  std::size_t i = 0;
+  for (; i < rhs.size(); ++i) {
+    int cur = lhs[i] + rhs[i] + carry;
+    if (cur >= BASE) {
+      cur -= BASE;
+      carry = 1;
+    } else {
+      carry = 0;
+    }
+    lhs[i] = cur;
+  }
+  for (; carry && i < lhs.size(); ++i) {
+    if (lhs[i] == BASE - 1) {
+      lhs[i] = 0;
+    } else {
+      ++lhs[i];
+      carry = 0;
+    }
+  }
+  if (carry)
+    lhs.push_back(carry);
+}
+
+void int2048::abs_sub_inplace(limb_vector &lhs, const limb_vector &rhs) {
+  int carry = 0;
+  std::size_t i = 0;
+  for (; i < rhs.size(); ++i) {
+    int cur = lhs[i] - rhs[i] - carry;
+    if (cur < 0) {
+      cur += BASE;
+      carry = 1;
+    } else {
+      carry = 0;
+    }
+    lhs[i] = cur;
+  }
+  for (; carry && i < lhs.size(); ++i) {
+    if (lhs[i] == 0) {
+      lhs[i] = BASE - 1;
+    } else {
+      --lhs[i];
+      carry = 0;
+    }
+  }
+  while (!lhs.empty() && lhs.back() == 0)
+    lhs.pop_back();
+}
+
+void int2048::abs_rsub_inplace(limb_vector &lhs, const limb_vector &rhs) {
+  const std::size_t n = lhs.size();
+  lhs.resize(rhs.size(), 0);
+  int carry = 0;
+  for (std::size_t i = 0; i < rhs.size(); ++i) {
+    int cur = rhs[i] - (i < n ? lhs[i] : 0) - carry;
+    if (cur < 0) {
+      cur += BASE;
+      carry = 1;
+    } else {
+      carry = 0;
+    }
+    lhs[i] = cur;
+  }
+  while (!lhs.empty() && lhs.back() == 0)
+    lhs.pop_back();
+}
+
+void int2048::fft(std::complex<double> *a, std::size_t n, bool invert) {
+  const fft_plan &plan = get_fft_plan(n);
+  for (std::size_t i = 1; i < n; ++i) {
+    std::size_t j = plan.rev[i];
+    if (i < j) {
+      std::complex<double> tmp = a[i];
+      a[i] = a[j];
+      a[j] = tmp;
+    }
+  }
+
+  for (std::size_t half = 1; half < n; half <<= 1) {
+    const std::complex<double> *w = plan.roots.data() + half;
+    for (std::size_t i = 0; i < n; i += 2 * half) {
+      for (std::size_t j = 0; j < half; ++j) {
+        std::complex<double> u = a[i + j];
+        std::complex<double> v = a[i + j + half] * w[j];
+        a[i + j] = u + v;
+        a[i + j + half] = u - v;
+      }
+    }
+  }
+
+  // The inverse transform is the forward one with the outputs 1..n-1 reversed.
+  if (invert) {
+    for (std::size_t i = 1, j = n - 1; i < j; ++i, --j) {
+      std::complex<double> tmp = a[i];
+      a[i] = a[j];
+      a[j] = tmp;
+    }
+    for (std::size_t i = 0; i < n; ++i)
+      a[i] /= double(n);
+  }
+}
+
+limb_vector int2048::square_schoolbook(const limb_vector &a) {
+  if (a.empty())
+    return {};
+  scratch_vector<long long> acc(2 * a.size(), 0);
+  for (std::size_t i = 0; i < a.size(); ++i) {
+    for (std::size_t j = i + 1; j < a.size(); ++j)
+      acc[i + j] += 2ll * a[i] * a[j];
+    acc[2 * i] += 1ll * a[i] * a[i];
+  }
+  return carry_coefficients(acc.data(), acc.size());
+}
+
+limb_vector int2048::multiply_schoolbook(const limb_vector &lhs, const limb_vector &rhs) {
+  if (lhs.empty() || rhs.empty())
+    return {};
+  limb_vector res(lhs.size() + rhs.size(), 0);
+  for (std::size_t i = 0; i < lhs.size(); ++i) {
+    long long carry = 0;
+    for (std::size_t j = 0; j < rhs.size() || carry; ++j) {
+      long long cur = res[i + j] + carry;
+      if (j < rhs.size())
+        cur += 1ll * lhs[i] * rhs[j];
+      res[i + j] = int(cur % BASE);
+      carry = cur / BASE;
+    }
+  }
+  while (!res.empty() && res.back() == 0)
+    res.pop_back();
+  return res;
+}
+
+limb_vector int2048::multiply_recursive(const limb_vector &lhs, const limb_vector &rhs) {
+  // The longer operand is cut into blocks as long as the shorter one, so every
+  // recursive product is balanced.
+  const limb_vector &a = lhs.size() >= rhs.size() ? lhs : rhs;
+  const limb_vector &b = lhs.size() >= rhs.size() ? rhs : lhs;
+  const std::size_t m = b.size();
+  if (m == 0)
+    return {};
+
+  scratch_vector<long long> bl(b.begin(), b.end()), al(m), prod(2 * m - 1);
+  scratch_vector<long long> acc(a.size() + m, 0);
+  for (std::size_t off = 0; off < a.size(); off += m) {
+    std::size_t len = a.size() - off < m ? a.size() - off : m;
+    for (std::size_t i = 0; i < m; ++i)
+      al[i] = i < len ? a[off + i] : 0;
+    poly_mul(al.data(), bl.data(), m, prod.data());
+    for (std::size_t i = 0; i < 2 * m - 1 && off + i < acc.size(); ++i)
+      acc[off + i] += prod[i];
+  }
+  return carry_coefficients(acc.data(), acc.size());
+}
+
+limb_vector int2048::square_recursive(const limb_vector &a) {
+  if (a.empty())
+    return {};
+  scratch_vector<long long> al(a.begin(), a.end()), prod(2 * a.size() - 1);
+  poly_sqr(al.data(), a.size(), prod.data());
+  return carry_coefficients(prod.data(), prod.size());
+}
+
+void int2048::fft_packed_product(std::complex<double> *p, std::size_t n) {
+  fft(p, n, false);
+  // With P = A + iB, A[k] * B[k] = (P[k]^2 - conj(P[-k])^2) / 4i.
+  for (std::size_t k = 0; k <= n / 2; ++k) {
+    std::size_t j = (n - k) & (n - 1);
+    std::complex<double> pk = p[k], pj = p[j];
+    std::complex<double> ck = pk * pk - std::conj(pj * pj);
+    std::complex<double> cj = pj * pj - std::conj(pk * pk);
+    p[k] = std::complex<double>(ck.imag() / 4, -ck.real() / 4);
+    p[j] = std::complex<double>(cj.imag() / 4, -cj.real() / 4);
+  }
+  fft(p, n, true);
+}
+
+limb_vector int2048::multiply_fft(const limb_vector &lhs, const limb_vector &rhs) {
+  if (lhs.empty() || rhs.empty())
+    return {};
+
+  // Once the shorter operand is long enough that base-10000 coefficients could lose
+  // precision in double arithmetic, every limb is split into two base-100 digits.
+  const std::size_t shorter = lhs.size() < rhs.size() ? lhs.size() : rhs.size();
+  const bool split = shorter > FFT_SPLIT_THRESHOLD;
+  const std::size_t parts = split ? 2 : 1;
+
+  const std::size_t len = (lhs.size() + rhs.size()) * parts;
+  std::size_t n = 1;
+  while (n < len)
+    n <<= 1;
+
+  // Both real inputs share one complex transform: lhs in the real part, rhs in the
+  // imaginary part.
+  scratch_vector<std::complex<double>> fa(n);
+  for (std::size_t i = 0; i < lhs.size(); ++i) {
+    if (split) {
+      fa[2 * i].real(lhs[i] % 100);
+      fa[2 * i + 1].real(lhs[i] / 100);
+    } else {
+      fa[i].real(lhs[i]);
+    }
+  }
+  for (std::size_t i = 0; i < rhs.size(); ++i) {
+    if (split) {
+      fa[2 * i].imag(rhs[i] % 100);
+      fa[2 * i + 1].imag(rhs[i] / 100);
+    } else {
+      fa[i].imag(rhs[i]);
+    }
+  }
+
+  fft_packed_product(fa.data(), fa.size());
+
+  // Too close to a rounding boundary to trust; redo the product exactly.
+  limb_vector res;
+  if (!round_fft_result([&](std::size_t i) { return fa[i].real(); }, len, split, res))
+    return multiply_ntt(lhs, rhs);
+  return res;
+}
+
+limb_vector int2048::square_fft(const limb_vector &a) {
+  if (a.empty())
+    return {};
+
+  const bool split = a.size() > FFT_SPLIT_THRESHOLD;
+  const std::size_t parts = split ? 2 : 1;
+  const std::size_t len = 2 * a.size() * parts;
+  std::size_t n = 4;
+  while (n < len)
+    n <<= 1;
+  const std::size_t m = n / 2;
+
+  // A real sequence x of length n is transformed as z[j] = x[2j] + i x[2j+1] of
+  // length n / 2, so the square costs two half-length transforms.
+  scratch_vector<std::complex<double>> z(m);
+  for (std::size_t i = 0; i < a.size(); ++i) {
+    if (split) {
+      z[i] = std::complex<double>(a[i] % 100, a[i] / 100);
+    } else if (i & 1) {
+      z[i >> 1].imag(a[i]);
+    } else {
+      z[i >> 1].real(a[i]);
+    }
+  }
+
+  fft(z.data(), z.size(), false);
+  // E and O are the spectra of the even and odd samples, X[k] = E[k] + w^k O[k] and
+  // X[k + m] = E[k] - w^k O[k] with w = exp(2 pi i / n). Squaring and folding back
+  // the same way yields the half-length spectrum of y[2j] + i y[2j+1].
+  const std::complex<double> *w = get_fft_plan(n).roots.data() + m;
+  const std::complex<double> I(0.0, 1.0);
+  for (std::size_t k = 0; k <= m / 2; ++k) {
+    std::size_t j = (m - k) & (m - 1);
+    std::complex<double> zk = z[k], zj = z[j];
+    for (int pass = 0; pass < (k == j ? 1 : 2); ++pass) {
+      std::size_t idx = pass == 0 ? k : j;
+      std::complex<double> cur = pass == 0 ? zk : zj;
+      std::complex<double> mirror = std::conj(pass == 0 ? zj : zk);
+      std::complex<double> e = (cur + mirror) * 0.5;
+      std::complex<double> o = (cur - mirror) * (-0.5 * I);
+      std::complex<double> lo = e + w[idx] * o;
+      std::complex<double> hi = e - w[idx] * o;
+      lo *= lo;
+      hi *= hi;
+      std::complex<double> ey = (lo + hi) * 0.5;
+      std::complex<double> oy = (lo - hi) * 0.5 * std::conj(w[idx]);
+      z[idx] = ey + I * oy;
+    }
+  }
+  fft(z.data(), z.size(), true);
+
+  limb_vector res;
+  auto coef = [&](std::size_t i) { return (i & 1) ? z[i >> 1].imag() : z[i >> 1].real(); };
+  if (!round_fft_result(coef, len, split, res))
+    return multiply_ntt(a, a);
+  return res;
+}
+
+limb_vector int2048::multiply_ntt(const limb_vector &lhs, const limb_vector &rhs) {
+  if (lhs.empty() || rhs.empty())
+    return {};
+
+  scratch_vector<unsigned long long> conv = ntt_convolve(lhs, rhs);
+  limb_vector res(conv.size(), 0);
+  unsigned long long carry = 0;
+  for (std::size_t i = 0; i < conv.size(); ++i) {
+    unsigned long long cur = conv[i] + carry;
+    res[i] = int(cur % BASE);
+    carry = cur / BASE;
+  }
+  while (carry) {
+    res.push_back(int(carry % BASE));
+    carry /= BASE;
+  }
+  while (!res.empty() && res.back() == 0)
+    res.pop_back();
+  return res;
+}
+
+limb_vector int2048::multiply_vec(const limb_vector &lhs, const limb_vector &rhs) {
+  const std::size_t n = lhs.size();
+  const std::size_t m = rhs.size();
+  const std::size_t shorter = n < m ? n : m;
+  if (shorter <= SCHOOLBOOK_THRESHOLD)
+    return multiply_schoolbook(lhs, rhs);
+  if (shorter <= FFT_THRESHOLD)
+    return multiply_recursive(lhs, rhs);
+  if (current_backend == multiply_backend::ntt)
+    return multiply_ntt(lhs, rhs);
+  return multiply_fft(lhs, rhs);
+}
+
+limb_vector int2048::square_vec(const limb_vector &a) {
+  if (a.size() <= SCHOOLBOOK_THRESHOLD)
+    return square_schoolbook(a);
+  if (a.size() <= FFT_THRESHOLD)
+    return square_recursive(a);
+  if (current_backend == multiply_backend::ntt)
+    return multiply_ntt(a, a);
+  return square_fft(a);
+}
+
+void int2048::divmod_schoolbook(const limb_vector &x, const limb_vector &y, limb_vector &q, limb_vector &r) {
+  // Knuth Algorithm D. With the divisor normalized, the estimate from the top two remainder
+  // limbs over the top divisor limb, refined against the second divisor limb, is at most one
+  // too large; each quotient limb then costs one fused multiply-subtract pass over the
+  // divisor plus a rare add-back.
+  const int norm = BASE / (y.back() + 1);
+  limb_vector v = mul_vec_int(y, norm);
+  limb_vector u = mul_vec_int(x, norm);
+  const std::size_t n = v.size();
+  u.resize((x.size() > n ? x.size() : n) + 1, 0);
+  const std::size_t m = u.size() - n;
+
+  const int v1 = v[n - 1];
+  const int v2 = n >= 2 ? v[n - 2] : 0;
+  q.assign(m, 0);
+  for (std::size_t j = m; j-- > 0;) {
+    const int num = u[j + n] * BASE + u[j + n - 1];
+    int qhat = num / v1;
+    int rhat = num % v1;
+    if (qhat >= BASE) {
+      qhat = BASE - 1;
+      rhat = num - qhat * v1;
+    }
+    if (n >= 2) {
+      while (rhat < BASE && qhat * v2 > rhat * BASE + u[j + n - 2]) {
+        --qhat;
+        rhat += v1;
+      }
+    }
+    if (qhat == 0)
+      continue;
+
+    // u[j .. j + n] -= qhat * v
+    int carry = 0, borrow = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+      const int p = qhat * v[i] + carry;
+      carry = p / BASE;
+      int t = u[i + j] - (p - carry * BASE) - borrow;
+      borrow = t < 0;
+      u[i + j] = borrow ? t + BASE : t;
+    }
+    int top = u[j + n] - carry - borrow;
+    if (top < 0) {
+      // qhat was one too large: add the divisor back
+      --qhat;
+      int c = 0;
+      for (std::size_t i = 0; i < n; ++i) {
+        const int t = u[i + j] + v[i] + c;
+        c = t >= BASE;
+        u[i + j] = c ? t - BASE : t;
+      }
+      top += c;
+    }
+    u[j + n] = top;
+    q[j] = qhat;
+  }
+
+  trim_vec(q);
+  u.resize(n);
+  trim_vec(u);
+  if (norm != 1)
+    div_vec_int_inplace(u, norm);
+  r.swap(u);
+}
+
+limb_vector int2048::reciprocal_vec(const limb_vector &a) {
+  // MCA Algorithm 3.5 (ApproximateReciprocal): for a normalized a of n limbs, returns
+  // X = beta^n + ... with a * X < beta^(2n) <= a * (X + 2). Each level doubles the
+  // precision of the reciprocal of the top half with two multiplications.
+  const std::size_t n = a.size();
+  if (n <= NEWTON_BASECASE) {
+    limb_vector num(2 * n, BASE - 1), x, rem;
+    divmod_schoolbook(num, a, x, rem);
+    return x;
+  }
+
+  const std::size_t l = (n - 1) / 2;
+  const std::size_t h = n - l;
+  limb_vector xh = reciprocal_vec(limb_vector(a.begin() + l, a.end()));
+  limb_vector t = multiply_vec(a, xh);
+  limb_vector top(n + h + 1, 0);
+  top[n + h] = 1;
+  const limb_vector one(1, 1);
+  while (cmp_vec_abs(t, top) >= 0) {
+    abs_sub_inplace(xh, one);
+    abs_sub_inplace(t, a);
+  }
+  abs_rsub_inplace(t, top);
+
+  limb_vector u = multiply_vec(shifted_down(t, l), xh);
+  limb_vector x = shifted_down(u, 2 * h - l);
+  limb_vector xh_shifted(l, 0);
+  xh_shifted.insert(xh_shifted.end(), xh.begin(), xh.end());
+  abs_add_inplace(x, xh_shifted);
+  return x;
+}
+
+void int2048::divmod_reciprocal(const limb_vector &a, const limb_vector &b, const limb_vector &inv,
+                                limb_vector &q, limb_vector &r) {
+  // b is normalized and inv = reciprocal_vec(b). a is consumed in blocks of n = |b| limbs
+  // from the top; every partial dividend is below b * beta^n, so its quotient block is
+  // estimated from the top n + 1 limbs and inv, then corrected by at most a few steps.
+  const std::size_t n = b.size();
+  const limb_vector one(1, 1);
+  q.assign(a.size(), 0);
+  r.clear();
+  const std::size_t blocks = (a.size() + n - 1) / n;
+  for (std::size_t blk = blocks; blk-- > 0;) {
+    const std::size_t lo = blk * n;
+    const std::size_t hi = lo + n < a.size() ? lo + n : a.size();
+    limb_vector cur(a.begin() + lo, a.begin() + hi);
+    if (!r.empty()) {
+      cur.resize(hi - lo, 0);
+      cur.insert(cur.end(), r.begin(), r.end());
+    }
+    trim_vec(cur);
+    if (cmp_vec_abs(cur, b) < 0) {
+      r.swap(cur);
+      continue;
+    }
+
+    limb_vector qb = shifted_down(multiply_vec(shifted_down(cur, n - 1), inv), n + 1);
+    limb_vector p = multiply_vec(qb, b);
+    while (cmp_vec_abs(p, cur) > 0) {
+      abs_sub_inplace(qb, one);
+      abs_sub_inplace(p, b);
+    }
+    abs_rsub_inplace(p, cur);
+    while (cmp_vec_abs(p, b) >= 0) {
+      abs_add_inplace(qb, one);
+      abs_sub_inplace(p, b);
+    }
+    r.swap(p);
+    for (std::size_t i = 0; i < qb.size(); ++i)
+      q[lo + i] = qb[i];
+  }
+  trim_vec(q);
+}
+
+void int2048::divmod_newton(const limb_vector &x, const limb_vector &y, limb_vector &q, limb_vector &r) {
+  const std::size_t k = x.size() - y.size() + 1;
+  if (y.size() > k + NEWTON_GUARD) {
+    // A quotient of k limbs only depends on the top k + NEWTON_GUARD limbs of the divisor;
+    // dividing the truncated operands gives q within one unit, fixed against the full y.
+    const std::size_t s = y.size() - k - NEWTON_GUARD;
+    limb_vector rt;
+    divmod_newton(shifted_down(x, s), shifted_down(y, s), q, rt);
+    limb_vector p = multiply_vec(q, y);
+    const limb_vector one(1, 1);
+    while (cmp_vec_abs(p, x) > 0) {
+      abs_sub_inplace(q, one);
+      abs_sub_inplace(p, y);
+    }
+    abs_rsub_inplace(p, x);
+    while (cmp_vec_abs(p, y) >= 0) {
+      abs_add_inplace(q, one);
+      abs_sub_inplace(p, y);
+    }
+    r.swap(p);
+    return;
+  }
+
+  int norm = BASE / (y.back() + 1);
+  limb_vector a = mul_vec_int(x, norm);
+  limb_vector b = mul_vec_int(y, norm);
+  divmod_reciprocal(a, b, reciprocal_vec(b), q, r);
+  div_vec_int_inplace(r, norm);
+}
+
+void int2048::divmod_abs(const int2048 &x, const int2048 &y, int2048 &q, int2048 &r) {
+  // x >= 0, y > 0
+  if (x.sign_ == 0) {
+    q = 0;
+    r = 0;
+    return;
+  }
+  if (abs_compare(x, y) < 0) {
+    q = 0;
+    r = x;
+    return;
+  }
+
+  const std::size_t m = y.a_.size();
+  if (m <= 5) {
+    // divisors below 2^64 take the scalar kernel
+    unsigned __int128 d = 0;
+    for (std::size_t i = m; i-- > 0;)
+      d = d * BASE + y.a_[i];
+    if (d >> 64 == 0) {
+      q.a_ = x.a_;
+      unsigned long long rem = div_vec_u64_inplace(q.a_, (unsigned long long)d);
+      r.a_.clear();
+      for (; rem != 0; rem /= BASE)
+        r.a_.push_back(int(rem % BASE));
+      q.sign_ = q.a_.empty() ? 0 : 1;
+      r.sign_ = r.a_.empty() ? 0 : 1;
+      return;
+    }
+  }
+  const std::size_t k = x.a_.size() - m + 1;
+  if (m >= NEWTON_THRESHOLD && k >= NEWTON_THRESHOLD)
+    divmod_newton(x.a_, y.a_, q.a_, r.a_);
+  else
+    divmod_schoolbook(x.a_, y.a_, q.a_, r.a_);
+  q.sign_ = q.a_.empty() ? 0 : 1;
+  r.sign_ = r.a_.empty() ? 0 : 1;
+}
+
+void int2048::read(const std::string &s) { read(s.data(), s.data() + s.size()); }
+
+void int2048::read(const char *first, const char *last) {
+  sign_ = 0;
+  a_.clear();
+  int sgn = 1;
+  if (first != last && (*first == '-' || *first == '+')) {
+    sgn = *first == '-' ? -1 : 1;
+    ++first;
+  }
+  while (first != last && *first == '0')
+    ++first;
+  if (first == last)
+    return;
+
+  // Limbs are filled from the low end: the top limb takes the first n % 4 digits, every
+  // other one a group of four, two groups per step where possible.
+  const std::size_t n = std::size_t(last - first);
+  a_.resize((n + BASE_DIGITS - 1) / BASE_DIGITS);
+  std::size_t i = 0;
+  const char *p = last;
+  for (; i + 2 <= n / BASE_DIGITS; i += 2) {
+    p -= 2 * BASE_DIGITS;
+    const unsigned long long pair = parse_eight_digits(p);
+    a_[i] = int(pair >> 32);
+    a_[i + 1] = int(pair & 0xffff);
+  }
+  for (; i < n / BASE_DIGITS; ++i) {
+    p -= BASE_DIGITS;
+    a_[i] = parse_four_digits(p);
+  }
+  if (p != first) {
+    int cur = 0;
+    for (; first != p; ++first)
+      cur = cur * 10 + (*first - '0');
+    a_[i] = cur;
+  }
+  sign_ = sgn;
+}
+
+void int2048::print() { std::cout << *this; }
+
+struct int2048::radix_table {
+  int radix;
+  std::size_t chunk;        // digits per chunk
+  long long chunk_base;     // radix^chunk
+  std::vector<int2048> pow; // pow[k] = radix^(chunk 2^k)
+  std::vector<divisor> div; // div[k] prepared from pow[k], only built for printing
+
+  // Tables are cached per thread and per radix and only ever grow. They outlive any
+  // caller's int2048_resource_scope, so they are always built from the arena.
+  static radix_table &get(int radix) {
+    int2048_resource_scope arena(nullptr);
+    thread_local radix_table tables[37];
+    radix_table &t = tables[radix];
+    if (t.pow.empty()) {
+      t.radix = radix;
+      t.chunk = 0;
+      t.chunk_base = 1;
+      while (t.chunk_base * radix <= RADIX_CHUNK_LIMIT) {
+        t.chunk_base *= radix;
+        ++t.chunk;
+      }
+      t.pow.push_back(int2048(t.chunk_base));
+    }
+    return t;
+  }
+
+  void ensure_powers(std::size_t levels) {
+    int2048_resource_scope arena(nullptr);
+    while (pow.size() < levels) {
+      int2048 next = pow.back();
+      next.square();
+      pow.push_back(next);
+    }
+  }
+
+  void ensure_divisors(std::size_t levels) {
+    int2048_resource_scope arena(nullptr);
+    ensure_powers(levels);
+    while (div.size() < levels)
+      div.push_back(divisor(pow[div.size()]));
+  }
+};
+
+limb_vector int2048::parse_radix(const char *s, std::size_t n, const radix_table &t) {
+  if (n <= t.chunk * RADIX_BASECASE_CHUNKS) {
+    // res = res * radix^len + chunk, with the short chunk first
+    limb_vector res;
+    for (std::size_t i = 0; i < n;) {
+      const std::size_t len = i == 0 && n % t.chunk != 0 ? n % t.chunk : t.chunk;
+      long long scale = 1, carry = 0;
+      for (std::size_t j = 0; j < len; ++j) {
+        carry = carry * t.radix + radix_digit_value(s[i + j]);
+        scale *= t.radix;
+      }
+      for (std::size_t j = 0; j < res.size(); ++j) {
+        carry += res[j] * scale;
+        res[j] = int(carry % BASE);
+        carry /= BASE;
+      }
+      for (; carry; carry /= BASE)
+        res.push_back(int(carry % BASE));
+      i += len;
+    }
+    return res;
+  }
+  // the low block holds chunk 2^k < n digits
+  std::size_t k = 0;
+  while ((t.chunk << (k + 1)) < n)
+    ++k;
+  const std::size_t low = t.chunk << k;
+  limb_vector res = multiply_vec(parse_radix(s, n - low, t), t.pow[k].a_);
+  abs_add_inplace(res, parse_radix(s + n - low, low, t));
+  trim_vec(res);
+  return res;
+}
+
+void int2048::print_radix(const int2048 &x, std::size_t level, std::size_t width, const radix_table &t,
+                          std::string &out) {
+  // x < pow[level]; width is the exact digit count to emit, or 0 for no leading zeros
+  if (level == 0 || (std::size_t(1) << level) <= RADIX_BASECASE_CHUNKS) {
+    limb_vector a = x.a_;
+    std::string rev;
+    while (!a.empty()) {
+      unsigned long long c = div_vec_u64_inplace(a, (unsigned long long)t.chunk_base);
+      for (std::size_t j = 0; j < t.chunk; ++j, c /= t.radix)
+        rev.push_back(RADIX_DIGITS[c % t.radix]);
+    }
+    while (!rev.empty() && rev.back() == '0')
+      rev.pop_back();
+    if (rev.size() < width)
+      rev.resize(width, '0');
+    out.append(rev.rbegin(), rev.rend());
+    return;
+  }
+  const std::size_t low = t.chunk << (level - 1);
+  int2048 q, r;
+  t.div[level - 1].divmod(x, q, r);
+  if (width != 0 || q.sign_ != 0)
+    print_radix(q, level - 1, width != 0 ? width - low : 0, t, out);
+  print_radix(r, level - 1, width != 0 || q.sign_ != 0 ? low : 0, t, out);
+}
+
+char *int2048::format_limbs(const int *a, std::size_t n, char *out) {
+  const int skip = a[n - 1] >= 1000 ? 0 : a[n - 1] >= 100 ? 1 : a[n - 1] >= 10 ? 2 : 3;
+  std::memcpy(out, DIGIT_QUADS.text + 4 * a[n - 1] + skip, 4 - skip);
+  return format_quads(a, n - 1, out + 4 - skip);
+}
+
+std::size_t int2048::decimal_length() const {
+  if (sign_ == 0)
+    return 1;
+  const int top = a_.back();
+  const std::size_t top_digits = top >= 1000 ? 4 : top >= 100 ? 3 : top >= 10 ? 2 : 1;
+  return (sign_ < 0 ? 1 : 0) + top_digits + BASE_DIGITS * (a_.size() - 1);
+}
+
+char *int2048::to_chars(char *first, char *last) const {
+  if (std::size_t(last - first) < decimal_length())
+    return nullptr;
+  if (sign_ == 0) {
+    *first = '0';
+    return first + 1;
+  }
+  if (sign_ < 0)
+    *first++ = '-';
+  return format_limbs(a_.data(), a_.size(), first);
+}
+
+std::string int2048::to_string() const {
+  std::string s(decimal_length(), '0');
+  to_chars(&s[0], &s[0] + s.size());
+  return s;
+}
+
+void int2048::read(const std::string &s, int radix) {
+  if (radix == 10) {
+    read(s);
+    return;
+  }
+  sign_ = 0;
+  a_.clear();
+  std::size_t pos = 0;
+  int sgn = 1;
+  if (!s.empty() && (s[0] == '-' || s[0] == '+')) {
+    sgn = s[0] == '-' ? -1 : 1;
+    pos = 1;
+  }
+  while (pos < s.size() && s[pos] == '0')
+    ++pos;
+  if (pos == s.size())
+    return;
+
+  const std::size_t n = s.size() - pos;
+  radix_table &t = radix_table::get(radix);
+  std::size_t levels = 1;
+  while ((t.chunk << levels) < n)
+    ++levels;
+  t.ensure_powers(levels);
+  a_ = parse_radix(s.data() + pos, n, t);
+  sign_ = sgn;
+  trim();
+}
+
+std::string int2048::to_string(int radix) const {
+  if (radix == 10 || sign_ == 0)
+    return to_string();
+  std::string out;
+  if (sign_ < 0)
+    out.push_back('-');
+
+  // the smallest level with |x| < pow[level]; splitting it needs divisors below that
+  int2048 mag(*this);
+  mag.sign_ = 1;
+  radix_table &t = radix_table::get(radix);
+  std::size_t level = 0;
+  for (;; ++level) {
+    t.ensure_powers(level + 1);
+    if (abs_compare(mag, t.pow[level]) < 0)
+      break;
+  }
+  t.ensure_divisors(level);
+  print_radix(mag, level, 0, t, out);
+  return out;
+}
 
 int2048 &int2048::add(const int2048 &rhs) { return (*this += rhs); }
 
-int2048 add(int2048 lhs, const int2048 &rhs) { return lhs += rhs; }
+int2048 add(int2048 lhs, const int2048 &rhs) { return std::move(lhs += rhs); }
 
 int2048 &int2048::minus(const int2048 &rhs) { return (*this -= rhs); }
 
-int2048 minus(int2048 lhs, const int2048 &rhs) { return lhs -= rhs; }
+int2048 minus(int2048 lhs, const int2048 &rhs) { return std::move(lhs -= rhs); }
 
-int2048 int2048::operator+() const { return *this; }
+int2048 int2048::operator+() const & { return *this; }
 
-int2048 int2048::operator-() const {
+int2048 int2048::operator+() && { return std::move(*this); }
+
+int2048 int2048::operator-() const & {
   int2048 res(*this);
-  if (res.sign_ != 0)
-    res.sign_ = -res.sign_;
+  res.sign_ = -res.sign_;
   return res;
 }
 
+int2048 int2048::operator-() && {
+  sign_ = -sign_;
+  return std::move(*this);
+}
+
 int2048 &int2048::operator=(const int2048 &rhs) {
   if (this == &rhs)
     return *this;
@@ -425,16 +2001,29 @@ int2048 &int2048::operator=(const int2048 &rhs) {
   return *this;
 }
 
-int2048 &int2048::operator+=(const int2048 &rhs) {
-  if (rhs.sign_ == 0)
+int2048 &int2048::operator=(int2048 &&rhs) noexcept {
+  if (this == &rhs)
+    return *this;
+  sign_ = rhs.sign_;
+  a_ = std::move(rhs.a_);
+  rhs.sign_ = 0;
+  rhs.a_.clear();
+  return *this;
+}
+
+int2048 &int2048::add_signed(const int2048 &rhs, int rhs_sign) {
+  if (rhs_sign == 0)
     return *this;
   if (sign_ == 0) {
-    *this = rhs;
+    a_ = rhs.a_;
+    sign_ = rhs_sign;
     return *this;
   }
+  if (a_.size() <= WORD_LIMBS && rhs.a_.size() <= WORD_LIMBS)
+    return assign_word(sign_ * word_of(a_) + rhs_sign * word_of(rhs.a_));
 
-  if (sign_ == rhs.sign_) {
-    a_ = abs_add_vec(a_, rhs.a_);
+  if (sign_ == rhs_sign) {
+    abs_add_inplace(a_, rhs.a_);
   } else {
     int cmp = abs_compare(*this, rhs);
     if (cmp == 0) {
@@ -442,137 +2031,415 @@ int2048 &int2048::operator+=(const int2048 &rhs) {
       a_.clear();
       return *this;
     }
-    if (cmp > 0) {
-      a_ = abs_sub_vec(a_, rhs.a_);
-    } else {
-      a_ = abs_sub_vec(rhs.a_, a_);
-      sign_ = rhs.sign_;
-    }
+    if (cmp > 0) {
+      abs_sub_inplace(a_, rhs.a_);
+    } else {
+      abs_rsub_inplace(a_, rhs.a_);
+      sign_ = rhs_sign;
+    }
+  }
+  trim();
+  return *this;
+}
+
+int2048 &int2048::operator+=(const int2048 &rhs) { return add_signed(rhs, rhs.sign_); }
+
+int2048 operator+(int2048 lhs, const int2048 &rhs) { return std::move(lhs += rhs); }
+
+int2048 operator+(const int2048 &lhs, int2048 &&rhs) { return std::move(rhs += lhs); }
+
+int2048 &int2048::operator-=(const int2048 &rhs) { return add_signed(rhs, -rhs.sign_); }
+
+int2048 operator-(int2048 lhs, const int2048 &rhs) { return std::move(lhs -= rhs); }
+
+int2048 operator-(const int2048 &lhs, int2048 &&rhs) {
+  // lhs - rhs == -(rhs - lhs), which reuses the storage of the temporary; the sign flips
+  // last so that lhs is still intact when it aliases rhs
+  rhs -= lhs;
+  rhs.sign_ = -rhs.sign_;
+  return std::move(rhs);
+}
+
+int2048 &int2048::operator*=(const int2048 &rhs) {
+  if (sign_ == 0 || rhs.sign_ == 0) {
+    sign_ = 0;
+    a_.clear();
+    return *this;
+  }
+  unsigned long long prod;
+  if (a_.size() <= WORD_LIMBS && rhs.a_.size() <= WORD_LIMBS &&
+      !__builtin_mul_overflow((unsigned long long)word_of(a_), (unsigned long long)word_of(rhs.a_), &prod)) {
+    sign_ *= rhs.sign_;
+    word_to_limbs(prod, a_);
+    return *this;
+  }
+
+  if (&rhs == this)
+    a_ = square_vec(a_);
+  else
+    a_ = multiply_vec(a_, rhs.a_);
+
+  sign_ = sign_ * rhs.sign_;
+  trim();
+  return *this;
+}
+
+int2048 &int2048::square() {
+  a_ = square_vec(a_);
+  if (sign_ != 0)
+    sign_ = 1;
+  return *this;
+}
+
+int2048 operator*(int2048 lhs, const int2048 &rhs) { return std::move(lhs *= rhs); }
+
+int2048 operator*(const int2048 &lhs, int2048 &&rhs) { return std::move(rhs *= lhs); }
+
+void int2048::divmod_fix_signs(int a_sign, const int2048 &b, int2048 &q, int2048 &r) {
+  if (a_sign != b.sign_ && r.sign_ != 0) {
+    // round toward negative infinity: |q| + 1 and |b| - |r|
+    abs_add_inplace(q.a_, limb_vector(1, 1));
+    abs_rsub_inplace(r.a_, b.a_);
+    trim_vec(r.a_);
+  }
+  q.sign_ = q.a_.empty() ? 0 : a_sign * b.sign_;
+  r.sign_ = r.a_.empty() ? 0 : b.sign_;
+}
+
+void divmod(const int2048 &a, const int2048 &b, int2048 &q, int2048 &r) {
+  if (a.a_.size() <= WORD_LIMBS && b.a_.size() <= WORD_LIMBS) {
+    const long long x = a.sign_ * word_of(a.a_), y = b.sign_ * word_of(b.a_);
+    long long quot = x / y, rem = x % y;
+    if (rem != 0 && (rem < 0) != (y < 0)) {
+      --quot;
+      rem += y;
+    }
+    q.assign_word(quot);
+    r.assign_word(rem);
+    return;
+  }
+  // q and r may alias a or b, so the results are built in locals
+  int2048 quot, rem;
+  if (a.sign_ != 0) {
+    // divmod_abs only looks at magnitudes
+    int2048::divmod_abs(a, b, quot, rem);
+    int2048::divmod_fix_signs(a.sign_, b, quot, rem);
+  }
+  q = std::move(quot);
+  r = std::move(rem);
+}
+
+void divmod(const int2048 &a, long long b, int2048 &q, long long &r) {
+  q = a;
+  r = q.divmod_word(b);
+}
+
+long long int2048::divmod_word(long long b) {
+  if (a_.size() <= WORD_LIMBS) {
+    const long long x = sign_ * word_of(a_);
+    long long quot = x / b, rem = x % b;
+    if (rem != 0 && (rem < 0) != (b < 0)) {
+      --quot;
+      rem += b;
+    }
+    assign_word(quot);
+    return rem;
+  }
+  const unsigned long long d = word_abs(b);
+  const int a_sign = sign_;
+  unsigned long long rem = div_vec_u64_inplace(a_, d);
+  sign_ = a_.empty() ? 0 : (b < 0 ? -a_sign : a_sign);
+  if (rem != 0 && (a_sign < 0) != (b < 0)) {
+    add_word_inplace(a_, 1);
+    sign_ = -1;
+    rem = d - rem;
+  }
+  return b < 0 ? -(long long)rem : (long long)rem;
+}
+
+int2048 &int2048::operator/=(const int2048 &rhs) {
+  int2048 r;
+  divmod(*this, rhs, *this, r);
+  return *this;
+}
+
+int2048 operator/(int2048 lhs, const int2048 &rhs) { return std::move(lhs /= rhs); }
+
+int2048 &int2048::operator%=(const int2048 &rhs) {
+  int2048 q;
+  divmod(*this, rhs, q, *this);
+  return *this;
+}
+
+int2048 operator%(int2048 lhs, const int2048 &rhs) { return std::move(lhs %= rhs); }
+
+int2048 &int2048::add_word(unsigned long long m, int rhs_sign) {
+  if (m == 0)
+    return *this;
+  if (sign_ == 0 || sign_ == rhs_sign) {
+    sign_ = rhs_sign;
+    add_word_inplace(a_, m);
+    return *this;
+  }
+  // opposite signs: only magnitudes of at most U64_LIMBS limbs can be overtaken
+  if (a_.size() <= U64_LIMBS) {
+    const unsigned __int128 v = wide_word_of(a_);
+    if (v <= m) {
+      sign_ = v == m ? 0 : rhs_sign;
+      word_to_limbs(m - (unsigned long long)v, a_);
+      return *this;
+    }
   }
-  trim();
+  sub_word_inplace(a_, m);
   return *this;
 }
 
-int2048 operator+(int2048 lhs, const int2048 &rhs) { return lhs += rhs; }
+int2048 &int2048::operator+=(long long x) { return add_word(word_abs(x), word_sign(x)); }
 
-int2048 &int2048::operator-=(const int2048 &rhs) {
-  int2048 tmp = rhs;
-  if (tmp.sign_ != 0)
-    tmp.sign_ = -tmp.sign_;
-  return (*this += tmp);
+int2048 &int2048::operator-=(long long x) { return add_word(word_abs(x), -word_sign(x)); }
+
+int2048 &int2048::operator*=(long long x) {
+  if (sign_ == 0 || x == 0)
+    return assign_word(0);
+  const unsigned long long m = word_abs(x);
+  unsigned long long prod;
+  if (a_.size() <= WORD_LIMBS && !__builtin_mul_overflow((unsigned long long)word_of(a_), m, &prod)) {
+    word_to_limbs(prod, a_);
+  } else if (m < (1ull << 31)) {
+    mul_vec_int_inplace(a_, int(m));
+  } else {
+    limb_vector ml;
+    word_to_limbs(m, ml);
+    a_ = multiply_vec(a_, ml);
+  }
+  if (x < 0)
+    sign_ = -sign_;
+  return *this;
 }
 
-int2048 operator-(int2048 lhs, const int2048 &rhs) { return lhs -= rhs; }
+int2048 &int2048::operator/=(long long x) {
+  divmod_word(x);
+  return *this;
+}
 
-int2048 &int2048::operator*=(const int2048 &rhs) {
-  if (sign_ == 0 || rhs.sign_ == 0) {
-    sign_ = 0;
-    a_.clear();
-    return *this;
-  }
+int2048 &int2048::operator%=(long long x) { return assign_word(divmod_word(x)); }
 
-  const std::size_t n = a_.size();
-  const std::size_t m = rhs.a_.size();
-  if ((n <= 64 && m <= 64) || (n + m <= 256))
-    a_ = multiply_schoolbook(a_, rhs.a_);
-  else
-    a_ = multiply_fft(a_, rhs.a_);
+int2048 operator+(int2048 lhs, long long rhs) { return std::move(lhs += rhs); }
 
-  sign_ = sign_ * rhs.sign_;
-  trim();
-  return *this;
+int2048 operator+(long long lhs, int2048 rhs) { return std::move(rhs += lhs); }
+
+int2048 operator-(int2048 lhs, long long rhs) { return std::move(lhs -= rhs); }
+
+int2048 operator-(long long lhs, int2048 rhs) {
+  rhs.sign_ = -rhs.sign_;
+  return std::move(rhs += lhs);
 }
 
-int2048 operator*(int2048 lhs, const int2048 &rhs) { return lhs *= rhs; }
+int2048 operator*(int2048 lhs, long long rhs) { return std::move(lhs *= rhs); }
 
-int2048 &int2048::operator/=(const int2048 &rhs) {
-  int2048 q = (*this) / rhs;
-  *this = q;
-  return *this;
+int2048 operator*(long long lhs, int2048 rhs) { return std::move(rhs *= lhs); }
+
+int2048 operator/(int2048 lhs, long long rhs) { return std::move(lhs /= rhs); }
+
+int2048 operator%(int2048 lhs, long long rhs) { return std::move(lhs %= rhs); }
+
+int2048::divisor::divisor(const int2048 &d) : d_(d), norm_(1) {
+  if (d_.a_.size() < DIVISOR_RECIPROCAL_THRESHOLD)
+    return;
+  norm_ = BASE / (d_.a_.back() + 1);
+  b_ = mul_vec_int(d_.a_, norm_);
+  inv_ = reciprocal_vec(b_);
 }
 
-int2048 operator/(int2048 lhs, const int2048 &rhs) {
-  if (lhs.sign_ == 0)
-    return lhs;
+const int2048 &int2048::divisor::value() const { return d_; }
 
-  int2048 a = lhs;
-  int2048 b = rhs;
-  a.sign_ = a.sign_ == 0 ? 0 : 1;
-  b.sign_ = b.sign_ == 0 ? 0 : 1;
+int2048 int2048::divisor::div(const int2048 &a) const {
+  int2048 q, r;
+  divmod(a, q, r);
+  return q;
+}
 
-  int2048 qabs, rabs;
-  int2048::divmod_abs(a, b, qabs, rabs);
+int2048 int2048::divisor::mod(const int2048 &a) const {
+  int2048 q, r;
+  divmod(a, q, r);
+  return r;
+}
 
-  int2048 q;
-  int2048 rem;
-
-  bool same_sign = (lhs.sign_ == rhs.sign_);
-  if (same_sign) {
-    q = qabs;
-    q.sign_ = q.a_.empty() ? 0 : 1;
-    rem = rabs;
-    if (!rem.a_.empty())
-      rem.sign_ = rhs.sign_;
-  } else {
-    if (rabs.sign_ == 0) {
-      q = qabs;
-      if (q.sign_ != 0)
-        q.sign_ = -1;
-      rem = 0;
+void int2048::divisor::divmod(const int2048 &a, int2048 &q, int2048 &r) const {
+  int2048 quot, rem;
+  if (a.sign_ != 0) {
+    if (inv_.empty()) {
+      divmod_abs(a, d_, quot, rem);
+    } else if (abs_compare(a, d_) < 0) {
+      rem.a_ = a.a_;
+      rem.sign_ = 1;
     } else {
-      q = qabs;
-      q += int2048(1);
-      if (q.sign_ != 0)
-        q.sign_ = -1;
+      // the prepared reciprocal replaces divmod_newton's normalization and iteration
+      divmod_reciprocal(mul_vec_int(a.a_, norm_), b_, inv_, quot.a_, rem.a_);
+      div_vec_int_inplace(rem.a_, norm_);
+      quot.sign_ = quot.a_.empty() ? 0 : 1;
+      rem.sign_ = rem.a_.empty() ? 0 : 1;
+    }
+    divmod_fix_signs(a.sign_, d_, quot, rem);
+  }
+  q = std::move(quot);
+  r = std::move(rem);
+}
 
-      int2048 absb = b;
-      rem.a_ = int2048::abs_sub_vec(absb.a_, rabs.a_);
-      rem.sign_ = rem.a_.empty() ? 0 : rhs.sign_;
+struct int2048::montgomery_ring {
+  // Residues x of the n-limb modulus m are kept as x R mod m with R = BASE^n, which needs
+  // m coprime to BASE; redc(t) returns t / R mod m for any t < m R.
+  limb_vector m;
+  std::size_t n;
+  int m0_inv;             // -m^-1 mod BASE
+  limb_vector m_inv; // -m^-1 mod R, only from MONTGOMERY_REDC_THRESHOLD limbs on
+
+  explicit montgomery_ring(const limb_vector &mod) : m(mod), n(mod.size()) {
+    const int inv0 = inverse_mod_base(m[0]);
+    m0_inv = BASE - inv0;
+    if (n < MONTGOMERY_REDC_THRESHOLD)
+      return;
+    // Hensel lifting: m x = 1 mod BASE^p gives m x (2 - m x) = 1 mod BASE^(2p)
+    limb_vector x(1, inv0);
+    for (std::size_t p = 1; p < n;) {
+      p = 2 * p < n ? 2 * p : n;
+      limb_vector t = limb_slice(multiply_vec(limb_slice(m, 0, p), x), 0, p);
+      limb_vector two(p + 1, 0);
+      two[0] = 2;
+      two[p] = 1;
+      abs_rsub_inplace(t, two);
+      x = limb_slice(multiply_vec(x, limb_slice(t, 0, p)), 0, p);
     }
+    limb_vector r(n + 1, 0);
+    r[n] = 1;
+    abs_rsub_inplace(x, r);
+    m_inv.swap(x);
   }
 
-  q.trim();
-  return q;
-}
+  limb_vector redc(const limb_vector &t) const {
+    limb_vector res;
+    if (!m_inv.empty()) {
+      // q = t m' mod R makes t + q m divisible by R
+      limb_vector q = limb_slice(multiply_vec(limb_slice(t, 0, n), m_inv), 0, n);
+      limb_vector sum = multiply_vec(q, m);
+      abs_add_inplace(sum, t);
+      res = shifted_down(sum, n);
+    } else {
+      // clear one low limb per step; the carry out of limb i is pushed on right away,
+      // every other column only accumulates products below BASE^2
+      scratch_vector<long long> acc(2 * n + 1, 0);
+      for (std::size_t i = 0; i < t.size(); ++i)
+        acc[i] = t[i];
+      for (std::size_t i = 0; i < n; ++i) {
+        const long long u = acc[i] % BASE * m0_inv % BASE;
+        if (u != 0) {
+          for (std::size_t j = 0; j < n; ++j)
+            acc[i + j] += u * m[j];
+        }
+        acc[i + 1] += acc[i] / BASE;
+      }
+      res = carry_coefficients(acc.data() + n, n + 1);
+    }
+    if (cmp_vec_abs(res, m) >= 0)
+      abs_sub_inplace(res, m);
+    return res;
+  }
 
-int2048 &int2048::operator%=(const int2048 &rhs) {
-  int2048 r = (*this) % rhs;
-  *this = r;
-  return *this;
-}
+  limb_vector mul(const limb_vector &a, const limb_vector &b) const { return redc(multiply_vec(a, b)); }
+  limb_vector sqr(const limb_vector &a) const { return redc(square_vec(a)); }
+};
 
-int2048 operator%(int2048 lhs, const int2048 &rhs) {
-  int2048 q = lhs / rhs;
-  lhs -= q * rhs;
-  lhs.trim();
-  return lhs;
+struct int2048::barrett_ring {
+  // Plain residues in [0, m), reduced by the prepared divisor
+  const divisor &d;
+
+  explicit barrett_ring(const divisor &dm) : d(dm) {}
+
+  limb_vector reduce(limb_vector t) const {
+    int2048 x;
+    x.a_.swap(t);
+    x.sign_ = x.a_.empty() ? 0 : 1;
+    return d.mod(x).a_;
+  }
+
+  limb_vector mul(const limb_vector &a, const limb_vector &b) const { return reduce(multiply_vec(a, b)); }
+  limb_vector sqr(const limb_vector &a) const { return reduce(square_vec(a)); }
+};
+
+int2048 powmod(const int2048 &base, const int2048 &exp, const int2048 &mod) {
+  const int2048 m = mod.sign_ < 0 ? -mod : mod;
+  const int2048::divisor dm(m);
+  int2048 res;
+  if (exp.sign_ == 0) {
+    res = dm.mod(int2048(1));
+  } else {
+    const int2048 g = dm.mod(base);
+    if (g.sign_ != 0) {
+      const std::vector<unsigned> e = binary_words(exp.a_);
+      if (m.a_[0] % 2 != 0 && m.a_[0] % 5 != 0) {
+        const int2048::montgomery_ring ring(m.a_);
+        int2048 gr = g;
+        shift_up_inplace(gr.a_, ring.n);
+        res.a_ = ring.redc(pow_sliding_window(ring, dm.mod(gr).a_, e));
+      } else {
+        const int2048::barrett_ring ring(dm);
+        res.a_ = pow_sliding_window(ring, g.a_, e);
+      }
+      res.sign_ = res.a_.empty() ? 0 : 1;
+    }
+  }
+  // floor semantics put a residue modulo a negative m in (m, 0]
+  if (mod.sign_ < 0 && res.sign_ != 0)
+    res -= m;
+  return res;
 }
 
 std::istream &operator>>(std::istream &is, int2048 &x) {
-  std::string s;
-  is >> s;
-  x.read(s);
+  // Like extracting a std::string token, but straight from the stream buffer into a
+  // per-thread scratch string, so steady-state reads do not allocate.
+  std::istream::sentry guard(is);
+  if (!guard)
+    return is;
+  thread_local std::string token;
+  token.clear();
+  std::streambuf *sb = is.rdbuf();
+  for (int c = sb->sgetc();; c = sb->snextc()) {
+    if (c == std::char_traits<char>::eof()) {
+      is.setstate(std::ios_base::eofbit);
+      break;
+    }
+    if (c == ' ' || (c >= '\t' && c <= '\r'))
+      break;
+    token.push_back(char(c));
+  }
+  if (token.empty()) {
+    is.setstate(std::ios_base::failbit);
+    return is;
+  }
+  x.read(token.data(), token.data() + token.size());
   return is;
 }
 
 std::ostream &operator<<(std::ostream &os, const int2048 &x) {
+  // Digits are formatted into a stack buffer and written a block of limbs at a time.
+  const std::size_t BLOCK_LIMBS = 1024;
+  char buf[int2048::BASE_DIGITS * BLOCK_LIMBS + 1];
   if (x.sign_ == 0) {
-    os << '0';
+    os.write("0", 1);
     return os;
   }
+  char *p = buf;
   if (x.sign_ < 0)
-    os << '-';
-
-  int i = int(x.a_.size()) - 1;
-  os << x.a_[i];
-  for (--i; i >= 0; --i) {
-    int d = x.a_[i];
-    int div = int2048::BASE / 10;
-    while (div > 0) {
-      os << char('0' + (d / div));
-      d %= div;
-      div /= 10;
-    }
+    *p++ = '-';
+  for (std::size_t hi = x.a_.size(); hi > 0;) {
+    const std::size_t lo = hi > BLOCK_LIMBS ? hi - BLOCK_LIMBS : 0;
+    if (hi == x.a_.size())
+      p = int2048::format_limbs(x.a_.data() + lo, hi - lo, p);
+    else
+      p = format_quads(x.a_.data() + lo, hi - lo, p);
+    os.write(buf, p - buf);
+    p = buf;
+    hi = lo;
   }
   return os;
 }
@@ -608,4 +2475,585 @@ bool operator<=(const int2048 &lhs, const int2048 &rhs) { return !(rhs < lhs); }
 
 bool operator>=(const int2048 &lhs, const int2048 &rhs) { return !(lhs < rhs); }
 
+int int2048::compare_word(const int2048 &lhs, long long rhs) {
+  const int rhs_sign = word_sign(rhs);
+  if (lhs.sign_ != rhs_sign)
+    return lhs.sign_ < rhs_sign ? -1 : 1;
+  if (lhs.a_.size() > U64_LIMBS)
+    return lhs.sign_;
+  const unsigned __int128 v = wide_word_of(lhs.a_);
+  const unsigned long long m = word_abs(rhs);
+  return v == m ? 0 : (v < m ? -lhs.sign_ : lhs.sign_);
+}
+
+bool operator==(const int2048 &lhs, long long rhs) { return int2048::compare_word(lhs, rhs) == 0; }
+
+bool operator!=(const int2048 &lhs, long long rhs) { return int2048::compare_word(lhs, rhs) != 0; }
+
+bool operator<(const int2048 &lhs, long long rhs) { return int2048::compare_word(lhs, rhs) < 0; }
+
+bool operator>(const int2048 &lhs, long long rhs) { return int2048::compare_word(lhs, rhs) > 0; }
+
+bool operator<=(const int2048 &lhs, long long rhs) { return int2048::compare_word(lhs, rhs) <= 0; }
+
+bool operator>=(const int2048 &lhs, long long rhs) { return int2048::compare_word(lhs, rhs) >= 0; }
+
+bool operator==(long long lhs, const int2048 &rhs) { return int2048::compare_word(rhs, lhs) == 0; }
+
+bool operator!=(long long lhs, const int2048 &rhs) { return int2048::compare_word(rhs, lhs) != 0; }
+
+bool operator<(long long lhs, const int2048 &rhs) { return int2048::compare_word(rhs, lhs) > 0; }
+
+bool operator>(long long lhs, const int2048 &rhs) { return int2048::compare_word(rhs, lhs) < 0; }
+
+bool operator<=(long long lhs, const int2048 &rhs) { return int2048::compare_word(rhs, lhs) >= 0; }
+
+bool operator>=(long long lhs, const int2048 &rhs) { return int2048::compare_word(rhs, lhs) <= 0; }
+
+std::vector<unsigned> int2048_bin::multiply_fft(const std::vector<unsigned> &lhs, const std::vector<unsigned> &rhs) {
+  const std::size_t shorter = lhs.size() < rhs.size() ? lhs.size() : rhs.size();
+  std::size_t w = 16;
+  while (w > 8) {
+    std::size_t digits = (32 * shorter + w - 1) / w, log_digits = 0;
+    while ((std::size_t(1) << log_digits) < digits)
+      ++log_digits;
+    if (log_digits + 2 * w <= BIN_FFT_COEFF_BITS)
+      break;
+    --w;
+  }
+  const unsigned long long mask = (1ull << w) - 1;
+  const std::size_t len = (32 * (lhs.size() + rhs.size()) + w - 1) / w;
+  std::size_t n = 1;
+  while (n < len)
+    n <<= 1;
+
+  // digit i holds bits [w i, w i + w) and may straddle two limbs
+  auto digit = [&](const std::vector<unsigned> &x, std::size_t i) {
+    const std::size_t pos = w * i, limb = pos / 32;
+    unsigned long long v = x[limb];
+    if (limb + 1 < x.size())
+      v |= (unsigned long long)x[limb + 1] << 32;
+    return double((v >> (pos % 32)) & mask);
+  };
+
+  // lhs in the real part, rhs in the imaginary part, as in int2048::multiply_fft
+  scratch_vector<std::complex<double>> fa(n);
+  for (std::size_t i = 0; i < (32 * lhs.size() + w - 1) / w; ++i)
+    fa[i].real(digit(lhs, i));
+  for (std::size_t i = 0; i < (32 * rhs.size() + w - 1) / w; ++i)
+    fa[i].imag(digit(rhs, i));
+
+  int2048::fft_packed_product(fa.data(), fa.size());
+
+  std::vector<unsigned> res(lhs.size() + rhs.size() + 1, 0);
+  unsigned long long carry = 0;
+  for (std::size_t i = 0; i < len; ++i) {
+    const double x = fa[i].real();
+    const double v = std::floor(x + 0.5);
+    if (std::fabs(x - v) > FFT_MAX_ERROR)
+      return mul_bin_ntt(lhs, rhs);
+    carry += (unsigned long long)v;
+    const std::size_t pos = w * i, limb = pos / 32;
+    const unsigned long long d = (carry & mask) << (pos % 32);
+    res[limb] |= unsigned(d);
+    res[limb + 1] |= unsigned(d >> 32);
+    carry >>= w;
+  }
+  trim_bin(res);
+  return res;
+}
+
+std::vector<unsigned> int2048_bin::multiply_vec(const std::vector<unsigned> &lhs, const std::vector<unsigned> &rhs) {
+  const std::vector<unsigned> &a = lhs.size() >= rhs.size() ? lhs : rhs;
+  const std::vector<unsigned> &b = lhs.size() >= rhs.size() ? rhs : lhs;
+  const std::size_t m = b.size();
+  if (m == 0)
+    return {};
+  if (m < BIN_KARATSUBA_THRESHOLD)
+    return mul_bin_basecase(a, b);
+  if (m >= BIN_FFT_THRESHOLD)
+    return multiply_fft(a, b);
+
+  std::vector<unsigned> res;
+  if (a.size() >= 2 * m) {
+    // the longer operand is cut into blocks as long as the shorter one
+    for (std::size_t off = 0; off < a.size(); off += m)
+      add_bin_at(res, multiply_vec(slice_bin(a, off, off + m), b), off);
+    trim_bin(res);
+    return res;
+  }
+
+  // Karatsuba: a = a0 + a1 x^h, b = b0 + b1 x^h with x = 2^32
+  const std::size_t h = (a.size() + 1) / 2;
+  std::vector<unsigned> a0 = slice_bin(a, 0, h), a1 = slice_bin(a, h, a.size());
+  std::vector<unsigned> b0 = slice_bin(b, 0, h), b1 = slice_bin(b, h, m);
+  std::vector<unsigned> z0 = multiply_vec(a0, b0);
+  std::vector<unsigned> z2 = multiply_vec(a1, b1);
+  add_bin_at(a0, a1, 0);
+  add_bin_at(b0, b1, 0);
+  std::vector<unsigned> z1 = multiply_vec(a0, b0);
+  sub_bin(z1, z0);
+  sub_bin(z1, z2);
+  res.swap(z0);
+  add_bin_at(res, z1, h);
+  add_bin_at(res, z2, 2 * h);
+  trim_bin(res);
+  return res;
+}
+
+const std::vector<unsigned> &int2048_bin::pow10000(std::size_t k) {
+  thread_local std::vector<unsigned> powers[64];
+  thread_local std::size_t ready = 0;
+  if (ready == 0) {
+    powers[0].assign(1, unsigned(LOCAL_BASE));
+    ready = 1;
+  }
+  for (; ready <= k; ++ready)
+    powers[ready] = multiply_vec(powers[ready - 1], powers[ready - 1]);
+  return powers[k];
+}
+
+const limb_vector &int2048_bin::pow2_base10000(std::size_t k) {
+  // like the radix tables, the cache is built from the arena whatever scope is open
+  int2048_resource_scope arena(nullptr);
+  thread_local limb_vector powers[64];
+  thread_local std::size_t ready = 0;
+  if (ready == 0) {
+    static const int two32[] = {7296, 9496, 42};
+    powers[0] = limb_vector(two32, two32 + 3);
+    ready = 1;
+  }
+  for (; ready <= k; ++ready)
+    powers[ready] = int2048::square_vec(powers[ready - 1]);
+  return powers[k];
+}
+
+// Both conversions split n limbs into a low block of 2^k < n limbs and the rest, convert
+// the halves recursively and recombine them with one multiplication by a cached power,
+// so a conversion costs O(M(n) log n).
+std::vector<unsigned> int2048_bin::from_base10000(const int *d, std::size_t n) {
+  if (n <= BIN_CONVERT_THRESHOLD) {
+    std::vector<unsigned> res;
+    for (std::size_t i = n; i-- > 0;) {
+      unsigned long long carry = unsigned(d[i]);
+      for (std::size_t j = 0; j < res.size(); ++j) {
+        carry += (unsigned long long)res[j] * LOCAL_BASE;
+        res[j] = unsigned(carry);
+        carry >>= 32;
+      }
+      if (carry)
+        res.push_back(unsigned(carry));
+    }
+    return res;
+  }
+  std::size_t k = 0;
+  while ((std::size_t(2) << k) < n)
+    ++k;
+  const std::size_t lo = std::size_t(1) << k;
+  std::vector<unsigned> high = from_base10000(d + lo, n - lo);
+  std::vector<unsigned> res = multiply_vec(high, pow10000(k));
+  add_bin_at(res, from_base10000(d, lo), 0);
+  trim_bin(res);
+  return res;
+}
+
+limb_vector int2048_bin::to_base10000(const unsigned *a, std::size_t n) {
+  if (n <= BIN_CONVERT_THRESHOLD) {
+    // one 16-bit half at a time keeps the Horner step within 64 bits
+    limb_vector res;
+    for (std::size_t i = n; i-- > 0;) {
+      for (int half = 1; half >= 0; --half) {
+        long long carry = (a[i] >> (16 * half)) & 0xffff;
+        for (std::size_t j = 0; j < res.size(); ++j) {
+          carry += res[j] * 65536ll;
+          res[j] = int(carry % LOCAL_BASE);
+          carry /= LOCAL_BASE;
+        }
+        for (; carry; carry /= LOCAL_BASE)
+          res.push_back(int(carry % LOCAL_BASE));
+      }
+    }
+    return res;
+  }
+  std::size_t k = 0;
+  while ((std::size_t(2) << k) < n)
+    ++k;
+  const std::size_t lo = std::size_t(1) << k;
+  limb_vector high = to_base10000(a + lo, n - lo);
+  limb_vector res = int2048::multiply_vec(high, pow2_base10000(k));
+  int2048::abs_add_inplace(res, to_base10000(a, lo));
+  trim_vec(res);
+  return res;
+}
+
+int2048_bin::int2048_bin() : sign_(0) {}
+
+int2048_bin::int2048_bin(long long x) : sign_(x < 0 ? -1 : x > 0 ? 1 : 0) {
+  unsigned long long mag = x < 0 ? 0ull - (unsigned long long)x : (unsigned long long)x;
+  for (; mag != 0; mag >>= 32)
+    a_.push_back(unsigned(mag));
+}
+
+int2048_bin::int2048_bin(const std::string &s) : sign_(0) { read(s); }
+
+int2048_bin::int2048_bin(const int2048 &x) : sign_(x.sign_), a_(from_base10000(x.a_.data(), x.a_.size())) {}
+
+int2048 int2048_bin::to_int2048() const {
+  int2048 res;
+  res.a_ = to_base10000(a_.data(), a_.size());
+  res.sign_ = res.a_.empty() ? 0 : sign_;
+  return res;
+}
+
+void int2048_bin::trim() {
+  trim_bin(a_);
+  if (a_.empty())
+    sign_ = 0;
+}
+
+void int2048_bin::read(const std::string &s) { *this = int2048_bin(int2048(s)); }
+
+void int2048_bin::print() { std::cout << *this; }
+
+int2048_bin int2048_bin::operator+() const { return *this; }
+
+int2048_bin int2048_bin::operator-() const {
+  int2048_bin res(*this);
+  res.sign_ = -res.sign_;
+  return res;
+}
+
+int2048_bin &int2048_bin::add_signed(const int2048_bin &rhs, int rhs_sign) {
+  if (rhs_sign == 0)
+    return *this;
+  if (sign_ == 0) {
+    a_ = rhs.a_;
+    sign_ = rhs_sign;
+    return *this;
+  }
+
+  if (sign_ == rhs_sign) {
+    add_bin_at(a_, rhs.a_, 0);
+  } else {
+    int cmp = cmp_bin(a_, rhs.a_);
+    if (cmp == 0) {
+      sign_ = 0;
+      a_.clear();
+      return *this;
+    }
+    if (cmp > 0) {
+      sub_bin(a_, rhs.a_);
+    } else {
+      rsub_bin(a_, rhs.a_);
+      sign_ = rhs_sign;
+    }
+  }
+  trim();
+  return *this;
+}
+
+int2048_bin &int2048_bin::operator+=(const int2048_bin &rhs) { return add_signed(rhs, rhs.sign_); }
+
+int2048_bin operator+(int2048_bin lhs, const int2048_bin &rhs) { return std::move(lhs += rhs); }
+
+int2048_bin &int2048_bin::operator-=(const int2048_bin &rhs) { return add_signed(rhs, -rhs.sign_); }
+
+int2048_bin operator-(int2048_bin lhs, const int2048_bin &rhs) { return std::move(lhs -= rhs); }
+
+int2048_bin &int2048_bin::operator*=(const int2048_bin &rhs) {
+  a_ = multiply_vec(a_, rhs.a_);
+  sign_ *= rhs.sign_;
+  trim();
+  return *this;
+}
+
+int2048_bin operator*(int2048_bin lhs, const int2048_bin &rhs) { return std::move(lhs *= rhs); }
+
+std::istream &operator>>(std::istream &is, int2048_bin &x) {
+  std::string s;
+  is >> s;
+  x.read(s);
+  return is;
+}
+
+std::ostream &operator<<(std::ostream &os, const int2048_bin &x) { return os << x.to_int2048(); }
+
+bool operator==(const int2048_bin &lhs, const int2048_bin &rhs) {
+  return lhs.sign_ == rhs.sign_ && lhs.a_ == rhs.a_;
+}
+
+bool operator!=(const int2048_bin &lhs, const int2048_bin &rhs) { return !(lhs == rhs); }
+
+bool operator<(const int2048_bin &lhs, const int2048_bin &rhs) {
+  if (lhs.sign_ != rhs.sign_)
+    return lhs.sign_ < rhs.sign_;
+  if (lhs.sign_ == 0)
+    return false;
+  int cmp = cmp_bin(lhs.a_, rhs.a_);
+  if (lhs.sign_ > 0)
+    return cmp < 0;
+  return cmp > 0;
+}
+
+bool operator>(const int2048_bin &lhs, const int2048_bin &rhs) { return rhs < lhs; }
+
+bool operator<=(const int2048_bin &lhs, const int2048_bin &rhs) { return !(rhs < lhs); }
+
+bool operator>=(const int2048_bin &lhs, const int2048_bin &rhs) { return !(lhs < rhs); }
+
+std::size_t int2048::serialized_size() const { return SERIAL_HEADER_SIZE + 2 * a_.size(); }
+
+char *int2048::serialize(char *out) const {
+  const unsigned short marker = SERIAL_ENDIAN_MARKER;
+  const unsigned long long count = a_.size();
+  std::memcpy(out, SERIAL_MAGIC, 3);
+  out[3] = char(SERIAL_VERSION);
+  std::memcpy(out + 4, &marker, 2);
+  out[6] = char(sign_);
+  out[7] = 0;
+  std::memcpy(out + 8, &count, 8);
+  out += SERIAL_HEADER_SIZE;
+  for (std::size_t i = 0; i < a_.size(); ++i, out += 2) {
+    const unsigned short limb = (unsigned short)a_[i];
+    std::memcpy(out, &limb, 2);
+  }
+  return out;
+}
+
+std::string int2048::serialize() const {
+  std::string s(serialized_size(), '\0');
+  serialize(&s[0]);
+  return s;
+}
+
+const char *int2048::deserialize(const char *first, const char *last, int2048 &x) {
+  const int2048_view view(first, last);
+  if (!view.valid())
+    return nullptr;
+  int2048 res = view.to_int2048();
+  for (std::size_t i = 0; i < res.a_.size(); ++i)
+    if (res.a_[i] >= BASE)
+      return nullptr;
+  x = std::move(res);
+  return first + view.byte_size();
+}
+
+int2048_view::int2048_view() : data_(nullptr), swap_(false), sign_(0), limbs_(0) {}
+
+int2048_view::int2048_view(const char *first, const char *last) : int2048_view() {
+  const std::size_t len = std::size_t(last - first);
+  if (len < SERIAL_HEADER_SIZE || std::memcmp(first, SERIAL_MAGIC, 3) != 0 ||
+      (unsigned char)first[3] != int2048::SERIAL_VERSION)
+    return;
+  unsigned short marker;
+  std::memcpy(&marker, first + 4, 2);
+  const bool swap = marker != SERIAL_ENDIAN_MARKER;
+  if (swap && marker != (unsigned short)(SERIAL_ENDIAN_MARKER >> 8 | SERIAL_ENDIAN_MARKER << 8))
+    return;
+  const int sign = (signed char)first[6];
+  unsigned long long count;
+  std::memcpy(&count, first + 8, 8);
+  if (swap)
+    count = __builtin_bswap64(count);
+  if (sign < -1 || sign > 1 || (sign == 0) != (count == 0) || count > (len - SERIAL_HEADER_SIZE) / 2)
+    return;
+  data_ = first;
+  swap_ = swap;
+  sign_ = sign;
+  limbs_ = std::size_t(count);
+}
+
+bool int2048_view::valid() const { return data_ != nullptr; }
+
+int int2048_view::sign() const { return sign_; }
+
+std::size_t int2048_view::limb_count() const { return limbs_; }
+
+int int2048_view::limb(std::size_t i) const {
+  unsigned short v;
+  std::memcpy(&v, data_ + SERIAL_HEADER_SIZE + 2 * i, 2);
+  if (swap_)
+    v = (unsigned short)(v >> 8 | v << 8);
+  return v;
+}
+
+std::size_t int2048_view::byte_size() const { return valid() ? SERIAL_HEADER_SIZE + 2 * limbs_ : 0; }
+
+int2048 int2048_view::to_int2048() const {
+  int2048 res;
+  res.a_.resize(limbs_);
+  const unsigned char *p = (const unsigned char *)data_ + SERIAL_HEADER_SIZE;
+  const int lo = swap_ ? 1 : 0;
+  for (std::size_t i = 0; i < limbs_; ++i, p += 2)
+    res.a_[i] = p[lo] | p[1 - lo] << 8;
+  res.sign_ = sign_;
+  res.trim();
+  return res;
+}
+
+int2048_reader::int2048_reader(std::istream &is, std::size_t chunk)
+    : sb_(is.rdbuf()), buf_(chunk < 16 ? 16 : chunk), pos_(0), end_(0) {}
+
+bool int2048_reader::refill() {
+  pos_ = 0;
+  end_ = std::size_t(sb_->sgetn(buf_.data(), std::streamsize(buf_.size())));
+  return end_ != 0;
+}
+
+bool int2048_reader::next_token(const char *&first, const char *&last) {
+  auto is_space = [](char c) { return c == ' ' || (c >= '\t' && c <= '\r'); };
+  while (true) {
+    while (pos_ < end_ && is_space(buf_[pos_]))
+      ++pos_;
+    if (pos_ < end_)
+      break;
+    if (!refill())
+      return false;
+  }
+  std::size_t start = pos_;
+  while (pos_ < end_ && !is_space(buf_[pos_]))
+    ++pos_;
+  if (pos_ < end_) {
+    // the whole token is in the buffer
+    first = buf_.data() + start;
+    last = buf_.data() + pos_;
+    return true;
+  }
+
+  carry_.assign(buf_.data() + start, buf_.data() + pos_);
+  while (refill()) {
+    while (pos_ < end_ && !is_space(buf_[pos_]))
+      ++pos_;
+    carry_.append(buf_.data(), buf_.data() + pos_);
+    if (pos_ < end_)
+      break;
+  }
+  first = carry_.data();
+  last = carry_.data() + carry_.size();
+  return true;
+}
+
+bool int2048_reader::read(int2048 &x) {
+  const char *first, *last;
+  if (!next_token(first, last))
+    return false;
+  x.read(first, last);
+  return true;
+}
+
+bool int2048_reader::read(long long &x) {
+  const char *first, *last;
+  if (!next_token(first, last))
+    return false;
+  const bool neg = *first == '-';
+  if (*first == '-' || *first == '+')
+    ++first;
+  unsigned long long v = 0;
+  for (; first != last; ++first)
+    v = v * 10 + unsigned(*first - '0');
+  x = neg ? (long long)(0ull - v) : (long long)v;
+  return true;
+}
+
+int2048_writer::int2048_writer(std::ostream &os, std::size_t capacity)
+    : os_(os), buf_(capacity < 64 ? 64 : capacity), used_(0) {}
+
+int2048_writer::~int2048_writer() { flush(); }
+
+void int2048_writer::flush() {
+  if (used_ != 0)
+    os_.write(buf_.data(), std::streamsize(used_));
+  used_ = 0;
+}
+
+int2048_writer &int2048_writer::write(const int2048 &x) {
+  char *end = x.to_chars(buf_.data() + used_, buf_.data() + buf_.size());
+  if (end == nullptr) {
+    flush();
+    end = x.to_chars(buf_.data(), buf_.data() + buf_.size());
+    if (end == nullptr) {
+      // longer than the whole buffer: operator<< streams it in blocks
+      os_ << x;
+      return *this;
+    }
+  }
+  used_ = std::size_t(end - buf_.data());
+  return *this;
+}
+
+int2048_writer &int2048_writer::write(long long x) {
+  if (buf_.size() - used_ < 21)
+    flush();
+  unsigned long long v = x < 0 ? 0ull - (unsigned long long)x : (unsigned long long)x;
+  char tmp[20];
+  int n = 0;
+  do {
+    tmp[n++] = char('0' + v % 10);
+    v /= 10;
+  } while (v != 0);
+  if (x < 0)
+    buf_[used_++] = '-';
+  while (n > 0)
+    buf_[used_++] = tmp[--n];
+  return *this;
+}
+
+int2048_writer &int2048_writer::put(char c) {
+  if (used_ == buf_.size())
+    flush();
+  buf_[used_++] = c;
+  return *this;
+}
+
+int2048_memory_resource::~int2048_memory_resource() {}
+
+void *int2048_memory_resource::allocate(std::size_t bytes, std::size_t align) { return do_allocate(bytes, align); }
+
+void int2048_memory_resource::deallocate(void *p, std::size_t bytes, std::size_t align) {
+  do_deallocate(p, bytes, align);
+}
+
+int2048_resource_scope::int2048_resource_scope(int2048_memory_resource *resource)
+    : previous_(thread_scratch.resource) {
+  thread_scratch.resource = resource;
+}
+
+int2048_resource_scope::~int2048_resource_scope() { thread_scratch.resource = previous_; }
+
+int2048_monotonic_resource::int2048_monotonic_resource(std::size_t initial_chunk)
+    : chunks_(nullptr), cur_(nullptr), end_(nullptr), next_chunk_(initial_chunk < 256 ? 256 : initial_chunk) {}
+
+int2048_monotonic_resource::~int2048_monotonic_resource() { release(); }
+
+void int2048_monotonic_resource::release() {
+  while (chunks_ != nullptr) {
+    char *next;
+    std::memcpy(&next, chunks_, sizeof(next));
+    ::operator delete(chunks_);
+    chunks_ = next;
+  }
+  cur_ = end_ = nullptr;
+}
+
+void *int2048_monotonic_resource::do_allocate(std::size_t bytes, std::size_t align) {
+  std::size_t pad = cur_ == nullptr ? 0 : (align - reinterpret_cast<std::size_t>(cur_) % align) % align;
+  if (cur_ == nullptr || pad + bytes > std::size_t(end_ - cur_)) {
+    std::size_t size = next_chunk_;
+    while (size < MONOTONIC_CHUNK_HEADER + align + bytes)
+      size *= 2;
+    next_chunk_ = size * 2;
+    char *chunk = static_cast<char *>(::operator new(size));
+    std::memcpy(chunk, &chunks_, sizeof(chunks_));
+    chunks_ = chunk;
+    cur_ = chunk + MONOTONIC_CHUNK_HEADER;
+    end_ = chunk + size;
+    pad = (align - reinterpret_cast<std::size_t>(cur_) % align) % align;
+  }
+  char *p = cur_ + pad;
+  cur_ = p + bytes;
+  return p;
+}
+
+void int2048_monotonic_resource::do_deallocate(void *, std::size_t, std::size_t) {}
+
 } // namespace sjtu